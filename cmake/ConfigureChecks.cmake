@@ -265,6 +265,18 @@ check_cxx_source_compiles(
 	"
 HAVE_ICONV_CONST)
 
+# Check for the __thread keyword, which the memory pools of the IR nodes use for their per-thread caches.
+check_cxx_source_compiles(
+	"
+	struct S {int a, b;};
+	static __thread struct S x;
+	int main(){return 0;}
+	"
+HAVE_THREAD_KEYWORD)
+if(HAVE_THREAD_KEYWORD)
+  set(ROSE_THREAD_LOCAL_STORAGE __thread)
+endif()
+
 check_cxx_source_compiles(
 	"
 	int i[ ( sizeof(wchar_t)==2 ? 1 : -1 ) ];
@@ -2082,6 +2082,7 @@ tests/roseTests/astFileIOTests/Makefile
 tests/roseTests/astInliningTests/Makefile
 tests/roseTests/astInterfaceTests/Makefile
 tests/roseTests/astLValueTests/Makefile
+tests/roseTests/astMatchingTests/Makefile
 tests/roseTests/astMergeTests/Makefile
 tests/roseTests/astOutliningTests/Makefile
 tests/roseTests/astPerformanceTests/Makefile
@@ -13,11 +13,34 @@
 #include <boost/unordered_map.hpp>
 #include <boost/unordered_set.hpp>
 #include <boost/foreach.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/mutex.hpp>
+#include <map>
+#include <ostream>
 #include <NodeFinderResult.h>
+#include <NodeFinderKey.h>
+#include <NodeFinderTypedResult.h>
+
+class DepthFirstIndexAttribute;
 
 class NodeFinder
 {
    public:
+      /* Options controlling the optional structural (Merkle) subtree hashes that can be
+       * computed while the index is built. A node's hash combines its variant with the
+       * hashes of its traversal successors, so two subtrees with equal hashes are
+       * structurally equivalent. Options can be or'ed together. */
+      enum StructuralHashOptions
+      {
+         STRUCTURAL_HASH_DISABLED = 0,
+         STRUCTURAL_HASH_VARIANTS = 1 << 0, // node variants and tree shape only
+         STRUCTURAL_HASH_NAMES = 1 << 1,    // also include declared and referenced names
+         STRUCTURAL_HASH_CONSTANTS = 1 << 2 // also include the values of literals
+      };
+
+      typedef boost::uint64_t structural_hash;
+
       // 0-arg constructor
       NodeFinder();
 
@@ -31,6 +54,10 @@ class NodeFinder
 		 * node currently being searched */
 		NodeFinder(SgNode *index_root, bool use_alt_method);
 
+      /* same as above but also computes a structural hash for every indexed node using
+       * the given StructuralHashOptions (see findEquivalent()). Adds O(n) to index building. */
+      NodeFinder(SgNode *index_root, bool use_alt_method, int structural_hash_options);
+
 		// use instead of default destrutor
 		void dispose();
 
@@ -49,6 +76,8 @@ class NodeFinder
 
 		void rebuildIndex(SgNode *index_root, bool use_alt_method);
 
+      void rebuildIndex(SgNode *index_root, bool use_alt_method, int structural_hash_options);
+
       /* Returns a NodeFinderResult containing the list of nodes of type search_type
        * that are descendants of of the node search_root. This function runs in O(1)
        * time because the returned NodeFinderResult merely indexes into an already
@@ -57,12 +86,34 @@ class NodeFinder
        * If no results are found, the size() method for the NodeFinderResult
        * will return 0.
        *
+       * find() (like findByKey() and findEquivalent()) never modifies the index, so
+       * it may be called from several threads at once (see NodeFinderParallel.h).
+       *
        * Preconditions: search_root must be a descendant of the index_root
        * node that was specified the last time the index was built; no
        * changes have occurred to the structure of the AST since the last
        * time the index was built. */
       NodeFinderResult find(SgNode *search_root, VariantT search_type);
 
+      /* Typed version of find(): returns the descendants of search_root of class T or of
+       * any subclass of T (e.g. find<SgStatement>(root) returns all statements) as T*, so
+       * no casts are needed when iterating the result. The variants to search for are
+       * derived from T once (see NodeFinderVariants), after which this costs one find()
+       * per variant T covers. Results for different variants are grouped by variant, so
+       * the result is in depth first order only within each variant (see
+       * NodeFinderTypedResult).
+       *
+       * Preconditions: same as find(). */
+      template <class T>
+      NodeFinderTypedResult<T> find(SgNode *search_root)
+      {
+         NodeFinderTypedResult<T> result;
+         const std::vector<VariantT> &variants = NodeFinderVariants<T>::get();
+         for(uint i = 0; i < variants.size(); i++)
+            result.append(find(search_root, variants[i]));
+         return result;
+      }
+
 		// returns the depth first index of an SgNode that has been indexed by NodeFinder
 		int getDepthFirstIndex(SgNode *node);
 
@@ -74,6 +125,51 @@ class NodeFinder
       // cost: O(1)
 		int getNumDescendants(SgNode *node);
 
+      /* Returns the structural hash of an indexed node. Only available when the index was
+       * built with structural hashing enabled. cost: O(1) */
+      structural_hash getStructuralHash(SgNode *node);
+
+      /* Returns a NodeFinderResult containing, in depth first order, every descendant of
+       * search_root whose subtree is structurally equivalent to the subtree rooted at node
+       * (as determined by the StructuralHashOptions the index was built with). node does
+       * not need to be a descendant of search_root. Runs in O(log(m)) time where m is the
+       * number of indexed subtrees sharing node's hash.
+       *
+       * Preconditions: the index was built with structural hashing enabled. */
+      NodeFinderResult findEquivalent(SgNode *search_root, SgNode *node);
+
+      /* Returns the hash -> nodes multimap built alongside the index. Every list holds
+       * the nodes sharing one structural hash in depth first order, so any list with more
+       * than one entry is a set of duplicate subtrees. cost: O(1) */
+      const boost::unordered_map<structural_hash, std::vector<SgNode*>*> &getStructuralHashMap();
+
+      /* Registers a secondary index that partitions the indexed nodes by the keys
+       * extractor assigns to them, and returns the id to pass to findByKey(). All
+       * secondary indexes are filled in by the same traversal that builds the main
+       * index, so rebuildIndex() must be called after adding indexes. The extractor
+       * is not owned by NodeFinder and must outlive it. */
+      int addKeyIndex(NodeFinderKeyExtractor *extractor);
+
+      /* Same as addKeyIndex() but takes any functor (or function pointer) mapping an
+       * SgNode* to a small non-negative integer key (or NodeFinderKeyExtractor::NO_KEY).
+       * The functor is copied and owned by this NodeFinder until dispose() is called. */
+      template <class KeyFunctor>
+      int addFunctorKeyIndex(KeyFunctor functor)
+      {
+         NodeFinderKeyExtractor *extractor = new NodeFinderFunctorKeyExtractor<KeyFunctor>(functor);
+         owned_key_extractors.push_back(extractor);
+         return addKeyIndex(extractor);
+      }
+
+      /* Returns a NodeFinderResult containing, in depth first order, the descendants of
+       * search_root that the extractor registered as key_index assigned the key search_key
+       * (e.g. every x86_call instruction in a SgAsmFunction). Like find(), runs in O(1)
+       * time with the default indexing method and in O(log(m)) time with the alternate
+       * indexing method, where m is the number of indexed nodes with that key.
+       *
+       * Preconditions: same as find(). */
+      NodeFinderResult findByKey(SgNode *search_root, int key_index, int search_key);
+
       /* Internal data structure used by NodeFinder classes to represent an
        * index into the node_map vector for a given node type */
       struct region_info
@@ -82,9 +178,95 @@ class NodeFinder
          int end_index; // exclusive
       };
 
+      /* Memory footprint and build time of the current index, as returned by stats().
+       * Byte counts are estimates of the heap memory held by each structure (including
+       * hash table buckets and per-entry allocation overhead). */
+      struct index_stats
+      {
+         bool use_alt_method;
+         int total_nodes;
+         size_t node_map_bytes; // per-variant node lists
+         size_t node_region_map_bytes; // per-node variant region maps (default method only)
+         size_t key_index_bytes; // key node lists and per-node key region maps
+         size_t structural_hash_bytes; // hash -> nodes multimap
+         size_t attribute_bytes; // depth first index attributes and their attribute map entries
+         size_t adaptive_table_bytes; // O(1) region tables of promoted variants (adaptive method only)
+         int promoted_variants; // number of variants with an O(1) region table
+         size_t total_bytes;
+         // average number of entries in a node's variant region map (default method only)
+         double average_region_entries;
+         // size of the node list of every indexed variant
+         std::map<VariantT, size_t> variant_list_sizes;
+         // wall clock seconds spent in each phase of the last rebuildIndex()
+         double clear_seconds; // freeing the previous index
+         double traversal_seconds; // traversing the AST and building the index
+         double cleanup_seconds; // freeing temporary build structures
+         // memory in use by the whole process (ROSE_MemoryUsage) when stats() was called
+         double process_memory_megabytes;
+      };
+
+      /* Returns memory and timing statistics for the current index. Runs in O(n) time
+       * for the default indexing method (region maps are visited) and O(v) time for the
+       * alternate method, where v is the number of indexed variants. */
+      index_stats stats();
+
+      // prints the result of stats() in a human readable form
+      void outputStats(std::ostream &out);
+
+      /* Switches to the adaptive indexing method, which is built like the alternate method
+       * (O(n) build, O(log(m)) finds) but additionally keeps an O(1) region table for the
+       * variants that are queried the most or have the longest node lists, as long as
+       * all tables fit in memory_budget_bytes. A table costs sizeof(int) per indexed node.
+       * find() counts the queries of each variant that has no table; adapt() promotes the
+       * variants passed to find() at least promotion_threshold times if the budget allows,
+       * and 0 disables runtime promotion. Query counts are kept across rebuilds and guide
+       * which variants get tables when the index is rebuilt. Takes effect on the next
+       * rebuildIndex(); choosing a method with rebuildIndex(index_root, use_alt_method)
+       * turns the adaptive method off again. */
+      void setAdaptiveMethod(size_t memory_budget_bytes, int promotion_threshold = 64);
+
+      /* Promotes (see promoteVariant()) the variants whose query count has reached
+       * promotion_threshold, most queried first, as long as the budget allows; a variant
+       * that did not fit is tried again by the next call. Returns the number of variants
+       * promoted. Must not run concurrently with find(). */
+      int adapt();
+
+      /* Builds the O(1) region table for search_type if the adaptive method is in use and
+       * the table fits in the remaining memory budget. Returns whether the variant now
+       * has a table. Runs in O(n) time. */
+      bool promoteVariant(VariantT search_type);
+
+      // returns whether search_type currently has an O(1) region table (adaptive method only)
+      bool isPromoted(VariantT search_type);
+
+      /* When enabled, every phase of rebuildIndex() is also timed with a TimingPerformance
+       * object, so index builds show up in AstPerformance::generateReport(). Off by default
+       * since every timer is kept until the report is generated. */
+      void setPerformanceReporting(bool enabled);
+
    private:
 		int current_df_index;
+      bool report_performance;
+      bool use_adaptive_method;
+      size_t adaptive_memory_budget;
+      size_t adaptive_bytes_used;
+      int promotion_threshold;
+      // per VariantT: number of times find() was called for it
+      std::vector<int> variant_query_counts;
+      // guards variant_query_counts in find() (shared by copies of the NodeFinder)
+      boost::shared_ptr<boost::mutex> query_count_mutex;
+      /* per VariantT: NULL, or for every depth first index i (and n, the total number of
+       * nodes) the number of nodes of that variant with a smaller depth first index, so
+       * the descendants of a node with index i and d descendants are the list entries
+       * [table[i + 1], table[i + d + 1]) */
+      std::vector<std::vector<int>*> variant_prefix_tables;
+      void selectAdaptiveVariants();
+      void clearAdaptiveTables();
+      double clear_seconds;
+      double traversal_seconds;
+      double cleanup_seconds;
 		bool use_alt_method;
+      int structural_hash_options;
       void rebuildIndex_helper(SgNode *node);
 		inline NodeFinderResult find_alt(SgNode *search_root, VariantT search_type);
 		inline void rebuildIndex_alt(SgNode *index_root);
@@ -103,17 +285,40 @@ class NodeFinder
 		inline region_info binarySearchRange(int start_target, int end_target, std::vector<SgNode*> *nodes);
 		inline int binarySearchRangeHelper(int target, int min, int max, bool is_start, std::vector<SgNode*> *nodes);
 
+      /* Used internally by both indexing methods once all children of node have been
+       * indexed. Combines the variant (and optionally name / constant value) of node with
+       * the hashes of its children and files node under the result in structural_hash_map. */
+      inline void computeStructuralHash(SgNode *node, DepthFirstIndexAttribute *att);
+
+      /* Sorts the lists of structural_hash_map by depth first index, which findEquivalent()
+       * relies on. Called once all nodes have been indexed. */
+      void sortStructuralHashLists();
+
+      /* Used internally by both indexing methods to add node to the secondary key indexes.
+       * The default method also passes the key region map of node, which is seeded with
+       * the regions of node's own keys. */
+      inline void indexKeys(SgNode *node, boost::unordered_map<boost::uint64_t, region_info> *key_regions);
+
       SgNode *index_root;
 
 		// index data structures
       boost::unordered_map<SgNode*, boost::unordered_map<VariantT, region_info>*> node_region_map;
       boost::unordered_map<SgNode*, boost::unordered_set<VariantT>*> node_contained_types;
       boost::unordered_map<VariantT, std::vector<SgNode*>*> node_map;
+      boost::unordered_map<structural_hash, std::vector<SgNode*>*> structural_hash_map;
+      std::vector<NodeFinderKeyExtractor*> key_extractors;
+      std::vector<boost::unordered_map<int, std::vector<SgNode*>*> > key_node_maps;
+      // (key index, key) -> region in the corresponding key_node_maps list
+      boost::unordered_map<SgNode*, boost::unordered_map<boost::uint64_t, region_info>*> node_key_region_map;
 
 		// data structures for tracking memory allocations used when building index
       std::vector<boost::unordered_map<VariantT, region_info>*> node_region_map_allocations;
       std::vector<boost::unordered_set<VariantT>*> node_contained_types_allocations;
       std::vector<std::vector<SgNode*>*> node_map_allocations;
+      std::vector<std::vector<SgNode*>*> structural_hash_map_allocations;
+      std::vector<std::vector<SgNode*>*> key_node_map_allocations;
+      std::vector<boost::unordered_map<boost::uint64_t, region_info>*> node_key_region_map_allocations;
+      std::vector<NodeFinderKeyExtractor*> owned_key_extractors;
 };
 
 
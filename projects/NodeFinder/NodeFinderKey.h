@@ -0,0 +1,56 @@
+/*
+ * NodeFinderKey.h
+ *
+ * Key extractors used by NodeFinder to build secondary indexes that
+ * partition nodes by something finer than their VariantT (see
+ * NodeFinder::addKeyIndex()).
+ */
+
+#ifndef ROSE_Project_NodeFinderKey_H
+#define ROSE_Project_NodeFinderKey_H
+#include <stdio.h>
+#include <rose.h>
+
+class NodeFinderKeyExtractor
+{
+   public:
+      // returned by getKey() for nodes that should not appear in the index
+      static const int NO_KEY = -1;
+
+      virtual ~NodeFinderKeyExtractor() {}
+
+      /* Returns the (non-negative) key node should be indexed under, or NO_KEY if
+       * node is not part of this index. Called once per node while the index is
+       * being built, so it should be cheap and must not modify the AST. */
+      virtual int getKey(SgNode *node) = 0;
+};
+
+/* Adapts any functor (or function pointer) callable as int(SgNode*) to a
+ * NodeFinderKeyExtractor, see NodeFinder::addFunctorKeyIndex(). The functor
+ * is copied and must return NodeFinderKeyExtractor::NO_KEY for nodes that
+ * should not be indexed. */
+template <class KeyFunctor>
+class NodeFinderFunctorKeyExtractor : public NodeFinderKeyExtractor
+{
+   public:
+      NodeFinderFunctorKeyExtractor(KeyFunctor functor) : functor(functor) {}
+      int getKey(SgNode *node) { return functor(node); }
+   private:
+      KeyFunctor functor;
+};
+
+/* Keys binary instructions of a single instruction set by their mnemonic, e.g. an
+ * InstructionKindKeyExtractor(V_SgAsmx86Instruction) indexes every SgAsmx86Instruction
+ * under its X86InstructionKind so that all x86_call instructions within a SgAsmFunction
+ * can be found with NodeFinder::findByKey(). Supported variants are
+ * V_SgAsmx86Instruction, V_SgAsmArmInstruction and V_SgAsmPowerpcInstruction. */
+class InstructionKindKeyExtractor : public NodeFinderKeyExtractor
+{
+   public:
+      InstructionKindKeyExtractor(VariantT instruction_type);
+      int getKey(SgNode *node);
+   private:
+      VariantT instruction_type;
+};
+
+#endif /* ROSE_Project_NodeFinderKey_H */
@@ -0,0 +1,140 @@
+/*
+ * NodeFinderParallel.h
+ *
+ * parallelForEach() runs the body of a (nested) NodeFinder query on several
+ * threads, e.g. "for each basic block, count the variable references":
+ *
+ *    std::vector<int> counts;
+ *    parallelForEach(finder.find(root, V_SgBasicBlock), CountVarRefs(finder), counts);
+ *
+ * NodeFinder::find(), findByKey() and findEquivalent() only read the index, so
+ * the body may call them as long as the index is not rebuilt (and the AST is
+ * not modified) meanwhile.
+ */
+
+#ifndef ROSE_Project_NodeFinderParallel_H
+#define ROSE_Project_NodeFinderParallel_H
+#include <stdio.h>
+#include <rose.h>
+#include <deque>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/locks.hpp>
+#include <WorkerPool.h>
+#include <NodeFinderResult.h>
+
+/* Chunks of the index range [0, size) spread over one work queue per worker.
+ * Used internally by parallelForEach(). */
+class NodeFinderWorkQueue
+{
+   public:
+      struct chunk
+      {
+         int begin_index; // inclusive
+         int end_index; // exclusive
+      };
+
+      NodeFinderWorkQueue(int size, int num_workers, int chunk_size);
+      ~NodeFinderWorkQueue();
+
+      /* Takes the next chunk for worker, first from the front of its own queue, then
+       * from the back of the other workers' queues. Returns false once no chunks are
+       * left. */
+      bool next(int worker, chunk &out);
+
+      /* Drops all chunks that have not been taken yet, so that every worker stops
+       * after its current chunk. */
+      void cancel();
+
+   private:
+      struct worker_queue
+      {
+         boost::mutex mutex;
+         std::deque<chunk> chunks;
+      };
+      std::vector<worker_queue*> queues;
+};
+
+// the number of threads parallelForEach() uses by default
+int getDefaultNodeFinderThreads();
+
+/* The workers of parallelForEach(): every worker takes chunks from the queue
+ * and reduces into its own buffer. */
+template <class Function, class Reduction>
+class NodeFinderParallelJob : public WorkerPool::Job
+{
+   public:
+      typedef WorkerPool::CacheLinePadded<Reduction> buffer;
+
+      NodeFinderParallelJob(SgNode **nodes, NodeFinderWorkQueue *queue, Function fn, std::vector<buffer> *buffers)
+         : nodes(nodes), queue(queue), fns(buffers->size(), WorkerPool::CacheLinePadded<Function>(fn)), buffers(buffers) {}
+      void work(size_t worker)
+      {
+         Function &worker_fn = fns[worker].value;
+         Reduction &worker_buffer = (*buffers)[worker].value;
+         try
+         {
+            NodeFinderWorkQueue::chunk work;
+            while(queue->next((int)worker, work))
+               for(int i = work.begin_index; i < work.end_index; i++)
+                  worker_fn(nodes[i], worker_buffer);
+         }
+         catch(...)
+         {
+            // the other workers stop after their current chunk
+            queue->cancel();
+            throw;
+         }
+      }
+   private:
+      SgNode **nodes;
+      NodeFinderWorkQueue *queue;
+      std::vector<WorkerPool::CacheLinePadded<Function> > fns;
+      std::vector<buffer> *buffers;
+};
+
+/* Calls fn(node, buffers[thread]) for every node in result on num_threads threads
+ * (the calling thread included), so fn needs no locking to reduce into its buffer;
+ * every thread works on its own copy of fn. buffers is reset to num_threads default
+ * constructed values. A num_threads or chunk_size of 0 selects a default. If fn
+ * throws, the remaining chunks are dropped and the first exception is rethrown once
+ * all threads are done. */
+template <class Function, class Reduction>
+void parallelForEach(NodeFinderResult result, Function fn, std::vector<Reduction> &buffers,
+   int num_threads = 0, int chunk_size = 0)
+{
+   if(num_threads <= 0) num_threads = getDefaultNodeFinderThreads();
+   buffers.assign(num_threads, Reduction());
+   if(result.size() == 0) return;
+   if(chunk_size <= 0) chunk_size = std::max(1, result.size() / (num_threads * 8));
+
+   // the threads reduce into buffers on cache lines of their own, which are handed
+   // to the caller afterwards
+   NodeFinderWorkQueue queue(result.size(), num_threads, chunk_size);
+   std::vector<WorkerPool::CacheLinePadded<Reduction> > padded_buffers(num_threads);
+   NodeFinderParallelJob<Function, Reduction> job(result.begin(), &queue, fn, &padded_buffers);
+   WorkerPool::run(job, num_threads);
+   for(int i = 0; i < num_threads; i++)
+      std::swap(buffers[i], padded_buffers[i].value);
+}
+
+// adapts fn(node) to the fn(node, buffer) form used by parallelForEach()
+template <class Function>
+class NodeFinderNoReduction
+{
+   public:
+      NodeFinderNoReduction(Function fn) : fn(fn) {}
+      void operator()(SgNode *node, char &) { fn(node); }
+   private:
+      Function fn;
+};
+
+/* Same as above for bodies that do not reduce anything: calls fn(node) for every node
+ * in result using num_threads threads. */
+template <class Function>
+void parallelForEach(NodeFinderResult result, Function fn, int num_threads = 0, int chunk_size = 0)
+{
+   std::vector<char> unused_buffers;
+   parallelForEach(result, NodeFinderNoReduction<Function>(fn), unused_buffers, num_threads, chunk_size);
+}
+
+#endif /* ROSE_Project_NodeFinderParallel_H */
@@ -0,0 +1,189 @@
+/*
+ * NodeFinderTypedResult.h
+ *
+ * Result of the typed NodeFinder::find<T>(search_root) queries: the nodes of
+ * type T (including all subclasses of T) below search_root, already cast to T*.
+ */
+
+#ifndef ROSE_Project_NodeFinderTypedResult_H
+#define ROSE_Project_NodeFinderTypedResult_H
+#include <stdio.h>
+#include <rose.h>
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <utility>
+#include <NodeFinderResult.h>
+
+/* Returns type and the variants of all of its subclasses, in increasing order, looked
+ * up in the ROSETTA generated class hierarchy cast table. The lists of all variants are
+ * computed together by the first call (from any thread), later calls only look them up. */
+const std::vector<VariantT> &getNodeFinderSubclassVariants(VariantT type);
+
+/* The variants find<T>() has to search for T, so typed queries for abstract classes
+ * never build a VariantVector at query time. */
+template <class T>
+class NodeFinderVariants
+{
+   public:
+      static const std::vector<VariantT> &get()
+      {
+         return getNodeFinderSubclassVariants((VariantT)T::static_variant);
+      }
+};
+
+/* A range of T* made up of one depth first ordered NodeFinderResult per variant that
+ * has matches (a single one unless T has subclasses). The nodes are grouped by variant,
+ * in increasing variant order, and are in depth first order within each variant; they
+ * are not merged into a single depth first order. Like NodeFinderResult it points into
+ * the index and is invalidated when the index is rebuilt. */
+template <class T>
+class NodeFinderTypedResult
+{
+   public:
+      typedef std::pair<SgNode**, SgNode**> segment;
+
+      class iterator
+      {
+         public:
+            // the nodes are cast on dereference, so the reference type is a value
+            typedef std::random_access_iterator_tag iterator_category;
+            typedef T* value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef T** pointer;
+            typedef T* reference;
+
+            iterator(const NodeFinderTypedResult *result, int segment_index, SgNode **current)
+               : result(result), segment_index(segment_index), current(current) {}
+            T* operator*() const { return static_cast<T*>(*current); }
+            T* operator[](std::ptrdiff_t n) const { return *(*this + n); }
+            iterator &operator++()
+            {
+               // the segments are never empty, so stepping off the end of one lands on the next
+               if(++current == result->getSegment(segment_index).second && segment_index + 1 < result->num_segments)
+                  current = result->getSegment(++segment_index).first;
+               return *this;
+            }
+            iterator operator++(int) { iterator old = *this; ++(*this); return old; }
+            iterator &operator--()
+            {
+               if(current == result->getSegment(segment_index).first)
+                  current = result->getSegment(--segment_index).second;
+               --current;
+               return *this;
+            }
+            iterator operator--(int) { iterator old = *this; --(*this); return old; }
+            iterator &operator+=(std::ptrdiff_t n)
+            {
+               const segment &nodes = result->getSegment(segment_index);
+               if(n >= nodes.first - current && n < nodes.second - current)
+                  current += n;
+               else
+                  *this = result->iteratorAt(position() + n);
+               return *this;
+            }
+            iterator &operator-=(std::ptrdiff_t n) { return *this += -n; }
+            iterator operator+(std::ptrdiff_t n) const { iterator it = *this; return it += n; }
+            iterator operator-(std::ptrdiff_t n) const { iterator it = *this; return it -= n; }
+            friend iterator operator+(std::ptrdiff_t n, const iterator &it) { return it + n; }
+            std::ptrdiff_t operator-(const iterator &other) const { return position() - other.position(); }
+            bool operator==(const iterator &other) const
+            {
+               return current == other.current && segment_index == other.segment_index;
+            }
+            bool operator!=(const iterator &other) const { return !(*this == other); }
+            bool operator<(const iterator &other) const { return position() < other.position(); }
+            bool operator>(const iterator &other) const { return other < *this; }
+            bool operator<=(const iterator &other) const { return !(other < *this); }
+            bool operator>=(const iterator &other) const { return !(*this < other); }
+         private:
+            // index of the node in the whole result
+            int position() const
+            {
+               return result->segmentOffset(segment_index) + (current - result->getSegment(segment_index).first);
+            }
+            const NodeFinderTypedResult *result;
+            int segment_index;
+            SgNode **current;
+      };
+      typedef iterator const_iterator;
+
+      NodeFinderTypedResult() : num_segments(0), total_size(0) {}
+
+      // appends the nodes of result (which must all be of type T or a subclass of T)
+      void append(NodeFinderResult result)
+      {
+         if(result.size() == 0) return;
+         segment nodes(result.begin(), result.end());
+         if(num_segments == 0)
+            first_segment = nodes;
+         else
+         {
+            more_segments.push_back(nodes);
+            more_offsets.push_back(total_size);
+         }
+         num_segments++;
+         total_size += result.size();
+      }
+
+      int size() const { return total_size; }
+
+      // returns the node at the given index, O(1) unless T has subclasses, O(log(v)) otherwise
+      // where v is the number of variants with matches
+      T* operator[](int index) const
+      {
+         ROSE_ASSERT(index >= 0 && index < total_size);
+         int segment_index = findSegment(index);
+         return static_cast<T*>(getSegment(segment_index).first[index - segmentOffset(segment_index)]);
+      }
+      T* get(int index) const { return (*this)[index]; }
+
+      iterator begin() const
+      {
+         return num_segments == 0 ? end() : iterator(this, 0, first_segment.first);
+      }
+      iterator end() const
+      {
+         if(num_segments == 0) return iterator(this, 0, NULL);
+         return iterator(this, num_segments - 1, getSegment(num_segments - 1).second);
+      }
+
+   private:
+      const segment &getSegment(int index) const
+      {
+         return index == 0 ? first_segment : more_segments[index - 1];
+      }
+
+      // number of nodes in the segments before the given one
+      int segmentOffset(int index) const
+      {
+         return index == 0 ? 0 : more_offsets[index - 1];
+      }
+
+      // returns the segment holding the node at the given index (which must be < total_size)
+      int findSegment(int index) const
+      {
+         if(index < first_segment.second - first_segment.first)
+            return 0;
+         return std::upper_bound(more_offsets.begin(), more_offsets.end(), index) - more_offsets.begin();
+      }
+
+      // returns the iterator to the node at the given index (or end() for total_size)
+      iterator iteratorAt(int index) const
+      {
+         ROSE_ASSERT(index >= 0 && index <= total_size);
+         if(index == total_size) return end();
+         int segment_index = findSegment(index);
+         return iterator(this, segment_index, getSegment(segment_index).first + (index - segmentOffset(segment_index)));
+      }
+
+      // the first segment is stored inline so single variant results don't allocate
+      segment first_segment;
+      std::vector<segment> more_segments;
+      // per segment in more_segments: the number of nodes in the segments before it
+      std::vector<int> more_offsets;
+      int num_segments;
+      int total_size;
+};
+
+#endif /* ROSE_Project_NodeFinderTypedResult_H */
@@ -448,6 +448,9 @@
 /* Define to 1 if you have the POSIX.1003 header file, <pthread.h> */
 #cmakedefine HAVE_PTHREAD_H 1
 
+/* Define to __thread keyword for thread local storage. */
+#cmakedefine ROSE_THREAD_LOCAL_STORAGE @ROSE_THREAD_LOCAL_STORAGE@
+
 /* Define to 1 if you have the `vprintf' function. */
 #cmakedefine HAVE_VPRINTF 1
 
@@ -556,6 +556,9 @@ class Grammar
      // Gets the number of columns in classHierarchyCastTable
      size_t getColumnsInClassHierarchyCastTable();
 
+     // Generates the table of traversal successor fields of each variant used by forEachTraversalSuccessor().
+     std::string generateTraversalSuccessorTable();
+
          //AS: build the function to get the class hierarchy subtree 
      std::string buildClassHierarchySubTreeFunction();
 
@@ -229,6 +229,10 @@
    #error "DEFAULT_CLASS_ALLOCATION_POOL_SIZE must be greater than zero!"
 #endif
 
+// Number of free IR nodes that a thread moves at once between its own allocation cache (magazine) and the
+// memory pool of an IR node class, see grammarNewDeleteOperatorMacros.macro. Zero disables the caches.
+#define DEFAULT_CLASS_ALLOCATION_MAGAZINE_SIZE 64
+
 // DQ (3/7/2010): This is no longer used (for several years) and we use an STL based implementation.
 // #define MAX_NUMBER_OF_MEMORY_BLOCKS        1000
 
@@ -242,6 +246,10 @@
 #define ROSE_MALLOC ::malloc
 #define ROSE_FREE ::free
 
+// The memory blocks of the memory pools are allocated zero-filled by the MemoryPoolAllocator, which can back
+// them with huge pages and place them on NUMA nodes, see grammarNewDeleteOperatorMacros.macro.
+#include "memoryPoolAllocator.h"
+
 // DQ (10/6/2006): Allow us to skip the support for caching so that we can measure the effects.
 #define SKIP_BLOCK_NUMBER_CACHING 0
 #define SKIP_MANGLED_NAME_CACHING 0
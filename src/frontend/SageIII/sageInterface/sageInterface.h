@@ -1511,6 +1511,12 @@ ROSE_DLL_API SgScopeStatement* getScope(const SgNode* astNode);
 //! Function to delete AST subtree's nodes only, users must take care of any dangling pointers, symbols or types that result.
 ROSE_DLL_API void deleteAST(SgNode* node);
 
+//! Delete the given IR nodes (destroyed in the given order) and return their memory to the memory pools in one batch per IR node type, which keeps the freed memory contiguous; as with deleteAST(), users must take care of dangling pointers. See also AST_FILE_IO::compactMemoryPools().
+ROSE_DLL_API void deleteNodesInBatches(const std::vector<SgNode*>& nodes);
+
+//! Delete the nodes of an AST subtree only (in postorder, like deleteAST() but without removing symbols and types), using deleteNodesInBatches().
+ROSE_DLL_API void bulkDeleteAST(SgNode* root);
+
 //! Special purpose function for deleting AST expression tress containing valid original expression trees in constant folded expressions (for internal use only).
 ROSE_DLL_API void deleteExpressionTreeWithOriginalExpressionSubtrees(SgNode* root);
 
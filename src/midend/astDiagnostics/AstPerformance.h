@@ -9,6 +9,7 @@
 #include <string>
 #include <vector>
 #include <list>
+#include <iosfwd>
 
 #ifdef _MSC_VER
 #include <time.h>
@@ -49,6 +50,28 @@
 typedef double RoseTimeType;
 
 
+//! Statistics of the memory pool of one IR node type (see ROSE_MemoryUsage::getMemoryPoolStatistics()).
+struct ROSE_DLL_API MemoryPoolStatistics
+   {
+     std::string className;
+     size_t objectSize;              //!< sizeof the IR node class
+     size_t objectsPerBlock;
+     size_t numberOfBlocks;
+     size_t numberOfLiveObjects;     //!< IR nodes currently allocated
+     size_t numberOfUnusedObjects;   //!< objects at the end of the newest block that were never handed out
+
+     MemoryPoolStatistics()
+        : objectSize(0), objectsPerBlock(0), numberOfBlocks(0), numberOfLiveObjects(0), numberOfUnusedObjects(0) {}
+
+     size_t capacity() const { return numberOfBlocks * objectsPerBlock; }
+
+  //! Number of free objects between the live ones (deleted IR nodes, and objects cached by threads for reuse).
+     size_t numberOfFreeObjects() const { return capacity() - numberOfLiveObjects - numberOfUnusedObjects; }
+
+  //! Fraction of the memory pool taken by free objects between the live ones (0 if the memory pool is empty).
+     double fragmentation() const { return capacity() == 0 ? 0.0 : (double)numberOfFreeObjects() / (double)capacity(); }
+   };
+
 class ROSE_MemoryUsage
    {
  //! Function that I got from Bill Henshaw (originally from PetSc), for computing current memory in use.
@@ -106,6 +129,10 @@ class ROSE_MemoryUsage
 
      double getNumberOfCodePlusLibraryMegabytes() const;
      double getMemoryUsageMegabytes() const;
+
+  // Statistics of the IR node memory pools (one entry for each IR node type), and a table of those that have blocks.
+     static std::vector<MemoryPoolStatistics> getMemoryPoolStatistics();
+     static void printMemoryPoolStatistics( std::ostream & os );
    };
 
 
@@ -12,18 +12,70 @@
 #include "RoseAst.h"
 #include <list>
 #include <set>
+#include <map>
+#include <boost/shared_ptr.hpp>
 
 class SgNode;
 
 class MatchOperation;
 
+/* A match expression compiled into its sequence of match operations,
+   with all variables resolved to slots (see MatchResultTable). A
+   compiled pattern can be used for any number of matches. */
+class MatchPattern {
+ public:
+  MatchPattern(std::string matchExpression);
+  ~MatchPattern();
+  const std::string& matchExpression() const { return _matchExpression; }
+  const MatchVariableList& variables() const { return _variables; }
+  MatchOperationList* matchOperationsSequence() const { return _matchOperationsSequence; }
+ private:
+  MatchPattern(const MatchPattern&);
+  MatchPattern& operator=(const MatchPattern&);
+  std::string _matchExpression;
+  MatchVariableList _variables;
+  MatchOperationList* _matchOperationsSequence;
+};
+
+typedef boost::shared_ptr<MatchPattern> MatchPatternPtr;
+
+/* Compiled patterns keyed by the text of the match expression. When
+   more than capacity patterns are cached the least recently used one
+   is dropped (it stays alive as long as it is referenced elsewhere).
+*/
+class MatchPatternCache {
+ public:
+  MatchPatternCache(size_t capacity=64);
+  /* returns the compiled pattern for matchExpression, compiling it
+     only if it is not in the cache */
+  MatchPatternPtr getPattern(const std::string& matchExpression);
+  void setCapacity(size_t capacity);
+  size_t size() const { return _index.size(); }
+  void clear();
+ private:
+  typedef std::list<MatchPatternPtr> LruList;
+  LruList _lru; // most recently used first
+  std::map<std::string,LruList::iterator> _index;
+  size_t _capacity;
+};
+
 class AstMatching {
  public:
   AstMatching();
   ~AstMatching();
   AstMatching(std::string matchExpression,SgNode* root);
+  /* The match expression is compiled only once and then taken from the
+     pattern cache shared by all AstMatching objects. */
   MatchResult performMatching(std::string matchExpression, SgNode* root);
+  const MatchResultTable& performMatching(MatchPatternPtr pattern, SgNode* root);
   MatchResult getResult();
+  /* The results of the last match as a table of variable bindings. This
+     avoids building the list of maps returned by getResult(). */
+  const MatchResultTable& getResultTable();
+  /* returns the compiled pattern for matchExpression from the shared
+     pattern cache */
+  static MatchPatternPtr compilePattern(std::string matchExpression);
+  static MatchPatternCache& patternCache();
   /* This function is useful when reusing the same matcher object for
      performing multiple matches. It allows to keep all nodes that
      have been marked by a previous match using the '#' operator. The
@@ -31,6 +83,21 @@ class AstMatching {
      either.
    */
   void setKeepMarkedLocations(bool keepMarked);
+  /* With more than one thread the AST is split into partitions: the
+     subtrees of the nodes of the partition variants (by default
+     SgFunctionDefinition; nested ones belong to the outermost
+     partition). The nodes outside of the partitions are matched first,
+     then the partitions are matched in parallel, each starting with the
+     locations marked outside of it. The results are in the same order
+     as with a single thread. A location marked inside a partition only
+     affects that partition, which differs from sequential matching only
+     for marked null values (these exclude all null values from
+     subsequent matches). The match operations are not modified when a
+     pattern is matched, hence a compiled pattern can be shared by all
+     threads; debug output is only supported with one thread.
+  */
+  void setNumberOfThreads(size_t numberOfThreads);
+  void setPartitionVariants(const std::vector<VariantT>& variants);
   /* This function is only for information purposes. It prints the
      sequence of internal match operations which are performed for a
      provided match-pattern.
@@ -41,16 +108,94 @@ class AstMatching {
   */
   void printMarkedLocations();
   bool performSingleMatch(SgNode* node, MatchOperationList* matchOperationSequence);
+  // state of a partition of the AST matched by a separate thread
+  struct MatchPartition {
+    SgNode* root;
+    // number of matches outside of the partitions preceding the partition
+    size_t matchesBefore;
+    // number of locations marked outside of the partitions before the
+    // partition (they are the first ones of the shared list)
+    size_t markedLocationsBefore;
+    MatchStatus status;
+  };
  private:
+  static bool performSingleMatch(SgNode* node, MatchOperationList* matchOperationSequence, MatchStatus& status, SingleMatchResult& smr);
   void performMatchingOnAst(SgNode* root);
+  /* if partitions is not 0, the subtrees of the partition roots below
+     root are not traversed but collected in partitions */
+  void performMatchingOnSubtree(SgNode* root, MatchStatus& status, SingleMatchResult& smr, std::vector<MatchPartition>* partitions);
+  void performParallelMatchingOnAst(SgNode* root);
+  friend class AstMatchingPartitionJob;
   void performMatching();
   void generateMatchOperationsSequence();
 
  private:
   std::string _matchExpression;
   SgNode* _root;
+  MatchPatternPtr _pattern;
   MatchOperationList* _matchOperationsSequence;
   MatchStatus _status;
+  SingleMatchResult _smr; // reused for every node
+  bool _keepMarkedLocations;
+  size_t _numberOfThreads;
+  std::vector<bool> _isPartitionVariant;
+};
+
+/* Matches any number of patterns in a single traversal of the AST.
+   For every node only the patterns which can match a node of its
+   variant at their root are tried (see
+   MatchOperation::collectRootVariants), hence the cost of the
+   traversal is shared by all patterns. Each pattern has its own match
+   status: nodes marked with '#' exclude their subtrees from
+   subsequent matches of the pattern that marked them only, exactly as
+   if the pattern were matched on its own with AstMatching.
+*/
+class AstMultiPatternMatching {
+ public:
+  /* a match with bound variables: the id of the pattern and the row of
+     the match in getResultTable(patternId) */
+  struct PatternMatch {
+    size_t patternId;
+    size_t match;
+  };
+  AstMultiPatternMatching();
+  /* adds a pattern and returns its id; ids are assigned consecutively
+     starting with 0 */
+  size_t addPattern(MatchPatternPtr pattern);
+  size_t addPattern(std::string matchExpression);
+  size_t numberOfPatterns() const;
+  void performMatching(SgNode* root);
+  /* all matches of the last performMatching in traversal order (for
+     matches at the same node in the order of the pattern ids) */
+  const std::vector<PatternMatch>& getMatches() const;
+  const MatchResultTable& getResultTable(size_t patternId) const;
+  void setKeepMarkedLocations(bool keepMarked);
+ private:
+  struct PatternState {
+    MatchPatternPtr pattern;
+    MatchStatus status;
+    // the pattern is not matched in the subtree of a location it marked
+    bool suppressed;
+  };
+  // a suppressed pattern and the depth of the marked location
+  struct Suppression {
+    size_t patternId;
+    int depth;
+  };
+  void buildPatternIndex();
+  void markLocations(size_t patternId, SingleMatchResult& smr);
+  void suppress(size_t patternId, int depth);
+  bool isMarked(SgNode* node, size_t patternId) const;
+  std::vector<PatternState> _patterns;
+  // patterns which can match a node of variant v at their root; entry V_SgNumVariants is used for null
+  std::vector<std::vector<size_t> > _patternsOfVariant;
+  std::map<SgNode*,std::vector<size_t> > _markedBy;
+  std::vector<PatternMatch> _matches;
+  // the suppressed patterns in the order of increasing depth, as the
+  // subtrees of the marked locations are nested
+  std::vector<Suppression> _suppressions;
+  SingleMatchResult _smr;
+  bool _indexValid;
   bool _keepMarkedLocations;
 };
 
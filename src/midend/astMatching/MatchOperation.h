@@ -9,46 +9,106 @@
 
 #include <string>
 #include <list>
+#include <deque>
 #include <sstream>
 #include <iostream>
 #include <set>
 #include <map>
+#include <vector>
 #include "RoseAst.h"
 
 typedef std::map<std::string,SgNode*> SingleMatchVarBindings;
-typedef RoseAst::iterator SingleMatchMarkedLocation;
+/* a marked location is the marked node; only the node is compared when
+   looking up marked locations, so the (much larger) iterator is not kept */
+typedef SgNode* SingleMatchMarkedLocation;
 typedef std::list<SingleMatchMarkedLocation> SingleMatchMarkedLocations;
 typedef std::list<SingleMatchVarBindings> MatchResult;
 
+/* the variables of a match pattern; the position of a variable in
+   this list is its slot in SingleMatchResult and MatchResultTable. */
+typedef std::vector<std::string> MatchVariableList;
+
 class MatchOpSequence;
 
 struct SingleMatchResult {
-  SingleMatchVarBindings singleMatchVarBindings;
+  SingleMatchResult();
+  SingleMatchResult(size_t numberOfVariables);
+  /* slot i holds the node bound to variable i of the pattern (which may
+     be 0); varBound[i] tells whether the variable has been bound. */
+  std::vector<SgNode*> varBindings;
+  std::vector<bool> varBound;
   SingleMatchMarkedLocations singleMatchMarkedLocations;
   bool success;
   void clear();
+  /* removes all bindings and marked locations but keeps the slots
+     (and their memory) such that the object can be reused */
+  void reset(size_t numberOfVariables);
+  size_t numberOfVariables() const { return varBindings.size(); }
+  void bindVariable(size_t slot, SgNode* node);
+  bool hasVarBindings() const;
   bool isSMRMarkedLocation(RoseAst::iterator& i);
+  /* exchanges the contents (and memory) of the two results */
+  void swap(SingleMatchResult& other);
+};
+
+/* The variable bindings of all matches of a pattern, stored as one
+   flat vector with one fixed-width row (one entry per variable of the
+   pattern) per match. Access by variable name is provided for
+   convenience; the slot of a variable can be looked up once with
+   slotOf() and used for all rows. */
+class MatchResultTable {
+ public:
+  MatchResultTable();
+  MatchResultTable(const MatchVariableList& variables);
+  static const size_t npos;
+  /* number of matches */
+  size_t size() const;
+  bool empty() const;
+  size_t numberOfVariables() const;
+  const MatchVariableList& variables() const;
+  /* returns the slot of the variable with name varName, or npos */
+  size_t slotOf(const std::string& varName) const;
+  /* returns the node bound to the variable in the given slot of match
+     number match, or 0 if the variable has not been bound in that match */
+  SgNode* binding(size_t match, size_t slot) const;
+  SgNode* binding(size_t match, const std::string& varName) const;
+  bool isBound(size_t match, size_t slot) const;
+  void append(const SingleMatchResult& smr);
+  void append(const MatchResultTable& other);
+  /* appends the matches first,...,last-1 of other */
+  void append(const MatchResultTable& other, size_t first, size_t last);
+  void clear();
+  /* converts the table into the list-of-maps representation */
+  MatchResult toMatchResult() const;
+ private:
+  MatchVariableList _variables;
+  std::vector<SgNode*> _bindings;
+  std::vector<bool> _bound;
 };
 
 class MatchStatus {
  public:
-  MatchStatus():debug(false),_allMatchVarBindings(0){
+  MatchStatus():debug(false),_inheritedMarkedLocations(0),_numInheritedMarkedLocations(0),_numScratchResultsInUse(0){
     resetAllMatchVarBindings();
     resetAllMarkedLocations();
   }
-  ~MatchStatus() {
-    delete _allMatchVarBindings; 
-  }
   enum PatternMatchMode {MATCHMODE_SHALLOW, MATCHMODE_DEEP, MATCHMODE_SINGLE};
   enum CheckNodeMode {NODECHECKMODE_TYPEID,NODECHECKMODE_VARIANT};
   bool isMarkedLocationAddress(RoseAst::iterator& i);
+  /* removes all match results; the variables are kept */
   void resetAllMatchVarBindings();
+  /* removes all match results and sets the variables of the pattern */
+  void resetAllMatchVarBindings(const MatchVariableList& variables);
   void resetAllMarkedLocations();
+  /* the first num locations of inherited are considered marked as well;
+     they are only read, such that several threads can share them */
+  void setInheritedMarkedLocations(const SingleMatchMarkedLocations* inherited, size_t num);
  public:
   bool debug;
   void mergeOtherStatus(MatchStatus& other);
+  /* moves the marked locations of other into the status */
   void mergeSingleMatchResult(SingleMatchResult& other);
-  std::list<SingleMatchVarBindings>* _allMatchVarBindings;
+  MatchResultTable _allMatchVarBindings;
   SingleMatchMarkedLocations _allMatchMarkedLocations;
 
   /* adds a single var binding to map of var bindings */
@@ -60,28 +120,69 @@ class MatchStatus {
      to be ready for new match */
   void commitSingleMatchResult();
  private:
+  friend class ScratchMatchResult;
   SingleMatchResult current_smr;
-  bool _keepMarkedLocations;
+  const SingleMatchMarkedLocations* _inheritedMarkedLocations;
+  size_t _numInheritedMarkedLocations;
+  /* the results of ScratchMatchResult; a deque, such that references
+     remain valid when it grows */
+  std::deque<SingleMatchResult> _scratchResults;
+  size_t _numScratchResultsInUse;
 };  
 
+/* An empty SingleMatchResult for the duration of a performOperation
+   call. The results are kept in the status and reused by later calls
+   at the same nesting depth of the pattern, hence the slots of a
+   result are allocated only once and not for each matched node. */
+class ScratchMatchResult {
+ public:
+  ScratchMatchResult(MatchStatus& status, size_t numberOfVariables);
+  ~ScratchMatchResult();
+  SingleMatchResult& get() { return _smr; }
+ private:
+  MatchStatus& _status;
+  SingleMatchResult& _smr;
+  ScratchMatchResult(const ScratchMatchResult&);
+  ScratchMatchResult& operator=(const ScratchMatchResult&);
+};
+
 class MatchOperation {
  public:
+  virtual ~MatchOperation() {}
   virtual std::string toString()=0;
   virtual bool performOperation(MatchStatus&  status, RoseAst::iterator& i, SingleMatchResult& vb);
+  /* assigns slots to the variables used in this operation; variables
+     which are not in the list yet are appended to it. Called once when
+     a pattern is compiled. */
+  virtual void assignVariableSlots(MatchVariableList& variables) {}
+  /* Determines the nodes a pattern can match at its root. Called for
+     the operations at the start of a pattern until one returns true:
+     an operation which does not check the current node returns false,
+     otherwise it marks the variants of the nodes it accepts in
+     rootVariants (entry V_SgNumVariants stands for null) and returns
+     true. The default accepts every node. */
+  virtual bool collectRootVariants(std::vector<bool>& rootVariants);
 };
 
 class MatchOpSequence : public std::list<MatchOperation*>{
   // we are using default std::list constructors
  public:
+  /* deletes the match operations in the sequence */
+  ~MatchOpSequence();
   std::string toString();
   bool performOperation(MatchStatus&  status, RoseAst::iterator& i, SingleMatchResult& vb);
+  void assignVariableSlots(MatchVariableList& variables);
+  bool collectRootVariants(std::vector<bool>& rootVariants);
 };
 
 class MatchOpOr : public MatchOperation {
  public:
  MatchOpOr(MatchOpSequence* l, MatchOpSequence* r):_left(l),_right(r){}
+  ~MatchOpOr();
   std::string toString();
   bool performOperation(MatchStatus& status, RoseAst::iterator& i, SingleMatchResult& vb);
+  void assignVariableSlots(MatchVariableList& variables);
+  bool collectRootVariants(std::vector<bool>& rootVariants);
  private:
   MatchOpSequence* _left;
   MatchOpSequence* _right;
@@ -92,26 +193,39 @@ class MatchOpVariableAssignment : public MatchOperation {
   MatchOpVariableAssignment(std::string varName);
   std::string toString();
   bool performOperation(MatchStatus&  status, RoseAst::iterator& i, SingleMatchResult& vb);
+  void assignVariableSlots(MatchVariableList& variables);
+  bool collectRootVariants(std::vector<bool>& rootVariants) { return false; }
  private:
   std::string _varName;
+  size_t _slot;
 };
 
+/* the node name is resolved to a VariantT when the pattern is compiled;
+   the check itself only compares variants. An unknown name never matches. */
 class MatchOpCheckNode : public MatchOperation {
  public:
   MatchOpCheckNode(std::string nodename);
   std::string toString();
   bool performOperation(MatchStatus&  status, RoseAst::iterator& i, SingleMatchResult& vb);
+  bool collectRootVariants(std::vector<bool>& rootVariants);
  private:
   std::string _nodename;
+  VariantT _variant;
 };
 
+/* matches nodes of the given class and of all its subclasses (this
+   also allows abstract classes such as SgExpression in a pattern). The
+   set of variants is computed once from the class hierarchy when the
+   pattern is compiled. */
 class MatchOpCheckNodeSet : public MatchOperation {
  public:
   MatchOpCheckNodeSet(std::string nodenameset);
   std::string toString();
   bool performOperation(MatchStatus&  status, RoseAst::iterator& i, SingleMatchResult& vb);
+  bool collectRootVariants(std::vector<bool>& rootVariants);
  private:
   std::string _nodenameset;
+  std::vector<bool> _variantSet;
 };
 
 class MatchOpArityCheck : public MatchOperation {
@@ -155,6 +269,7 @@ class MatchOpMarkNode : public MatchOperation {
   MatchOpMarkNode();
   std::string toString();
   bool performOperation(MatchStatus& status, RoseAst::iterator& i, SingleMatchResult& vb);
+  bool collectRootVariants(std::vector<bool>& rootVariants) { return false; }
  private:
 };
 
@@ -163,6 +278,7 @@ class MatchOpCheckNull : public MatchOperation {
   MatchOpCheckNull();
   std::string toString();
   bool performOperation(MatchStatus&  status, RoseAst::iterator& i, SingleMatchResult& vb);
+  bool collectRootVariants(std::vector<bool>& rootVariants);
  private:
 };
 
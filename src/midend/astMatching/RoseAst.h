@@ -106,7 +106,7 @@ class RoseAst {
     //! \internal
     void print_top_element() const;
 
-    //! info function
+    //! info function (depth of the current node relative to the root, the root being 1)
     int stack_size() const;
 
   protected:
@@ -117,8 +117,40 @@ class RoseAst {
   private:
     static const int ROOT_NODE_INDEX=-2;
     friend class RoseAst;
-    typedef struct {SgNode* node; int index;} stack_element;
-    std::stack<stack_element> _stack;
+    // fields are the traversal successor fields of node's type (see forEachTraversalSuccessor), unused for the root
+    typedef struct {SgNode* node; int index; const SgTraversalSuccessorField* fields;} stack_element;
+
+    /* The stack holds one (parent,index) element per level of the path from the
+       root to the current node, the root being represented as (root,ROOT_NODE_INDEX).
+       It is contiguous and keeps its first elements inside the iterator, so
+       copying an iterator (postfix ++, STL algorithms, lists of marked
+       locations in the matcher) copies only the elements in use and does not
+       allocate unless the AST is deeper than the inline capacity. */
+    class stack_type {
+    public:
+      stack_type();
+      stack_type(const stack_type& other);
+      stack_type& operator=(const stack_type& other);
+      ~stack_type();
+      void push(const stack_element& e);
+      void pop() { --_size; }
+      stack_element& top() { return _elements[_size-1]; }
+      const stack_element& top() const { return _elements[_size-1]; }
+      size_t size() const { return _size; }
+      bool empty() const { return _size==0; }
+    private:
+      static const size_t INLINE_CAPACITY=32;
+      stack_element _inline[INLINE_CAPACITY];
+      stack_element* _elements;
+      size_t _size;
+      size_t _capacity;
+    };
+    stack_type _stack;
+    // the node the iterator refers to (0 for null values and past-the-end)
+    SgNode* _current;
+
+    bool descend_to_first_child();
+    void advance_to_next_sibling();
     SgNode* access_node_by_parent_and_index(SgNode* p, int index) const;
 
     // not necessary with a children iterator
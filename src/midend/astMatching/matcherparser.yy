@@ -175,6 +175,7 @@ simple_expression:
         {
             $$=new MatchOperationList();
             $$->push_back(new MatchOpCheckNodeSet($2));
+            $$->push_back(new MatchOpSkipChildOnForward());
         }
         | '_'
         {
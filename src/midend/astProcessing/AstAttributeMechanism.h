@@ -7,8 +7,46 @@
 #include "AttributeMechanism.h"
 #include "rosedll.h"
 
+#include <cstddef>
+#include <iterator>
+#include <set>
+#include <string>
+#include <vector>
+
 class SgNode;
 
+/*!
+ *  \brief Interned name of an AST attribute.
+ *
+ *  The name is registered once when the key is built (typically as a static
+ *  object); afterwards keys are compared as integers, so looking up an
+ *  attribute by key does not compare any strings. All keys built from the
+ *  same name are equal. Building keys is thread safe.
+ */
+class ROSE_DLL_API AttributeKey
+   {
+     public:
+          typedef unsigned int Id;
+
+          explicit AttributeKey(const std::string & name);
+          explicit AttributeKey(const char* name);
+
+          Id id() const { return p_id; }
+       //! the name the key was built from (kept by the registry, so this takes no lock)
+          const std::string & name() const { return *p_name; }
+
+          bool operator==(const AttributeKey & X) const { return p_id == X.p_id; }
+          bool operator!=(const AttributeKey & X) const { return p_id != X.p_id; }
+          bool operator< (const AttributeKey & X) const { return p_id <  X.p_id; }
+
+       //! number of distinct names registered so far
+          static size_t numberOfKeys();
+
+     private:
+          Id p_id;
+          const std::string* p_name;
+   };
+
 class ROSE_DLL_API AstAttribute
    {
   // This class contains no data and is to be used as a based class (typically, but not required)
@@ -164,15 +202,64 @@ class MetricAttribute : public AstAttribute
 
 
 // DQ (6/28/2008):
-// Since this is implemented using AttributeMechanism which is derived from
-// std::map<Key,Value>, "Value" is a template parameter for "AstAttribute*"
-// And so the copy constructor will copy the pointer.  This is OK, but it
-// means that the AstAttribute objects are shared.  Alternatively, a copy
-// constructor implemented in this class could be implemented to support
-// deep copies.  This might be a good idea.
-class AstAttributeMechanism : public AttributeMechanism<std::string,AstAttribute*>
+// The copy constructor does a deep copy of the attributes (see AstAttribute::copy()),
+// so the AstAttribute objects are not shared between the copies.
+//
+// The attributes are kept in a small vector of (AttributeKey, attribute) entries, in
+// the order they were added; this is the only store. A node has only a few attributes,
+// so a linear scan comparing integers is much cheaper than a lookup in a map by string.
+// The interface by name (inherited from the former AttributeMechanism base class) is a
+// lookup into the same vector comparing the names: looking up a name does not register
+// it as an AttributeKey (no lock, no growth of the registry of keys), only adding an
+// attribute by name does.
+class AstAttributeMechanism
    {
+     private:
+          struct Entry
+             {
+               AttributeKey key;
+               AstAttribute* value;
+
+               Entry(const AttributeKey & key, AstAttribute* value) : key(key), value(value) {}
+             };
+          typedef std::vector<Entry> EntryList;
+
      public:
+          typedef std::set<std::string> AttributeIdentifiers;
+
+       //! Iterator over the attributes as (name, attribute) pairs: "i->first" is the name and "i->second" the attribute.
+          class iterator
+             {
+               public:
+                    struct NameAndAttribute
+                       {
+                         const std::string & first;
+                         AstAttribute* & second;
+
+                         NameAndAttribute(const std::string & first, AstAttribute* & second) : first(first), second(second) {}
+                         const NameAndAttribute* operator->() const { return this; }
+                       };
+
+                    typedef std::forward_iterator_tag iterator_category;
+                    typedef NameAndAttribute          value_type;
+                    typedef std::ptrdiff_t            difference_type;
+                    typedef NameAndAttribute          pointer;
+                    typedef NameAndAttribute          reference;
+
+                    iterator() {}
+                    NameAndAttribute operator*() const { return NameAndAttribute(p_entry->key.name(),p_entry->value); }
+                    NameAndAttribute operator->() const { return **this; }
+                    iterator & operator++() { ++p_entry; return *this; }
+                    iterator operator++(int) { iterator old = *this; ++p_entry; return old; }
+                    bool operator==(const iterator & X) const { return p_entry == X.p_entry; }
+                    bool operator!=(const iterator & X) const { return p_entry != X.p_entry; }
+
+               private:
+                    friend class AstAttributeMechanism;
+                    explicit iterator(EntryList::iterator entry) : p_entry(entry) {}
+                    EntryList::iterator p_entry;
+             };
+
        // DQ (7/27/2008): Build a copy constructor that will do a deep copy
        // instead of calling the default copy constructor.
           AstAttributeMechanism ( const AstAttributeMechanism & X );
@@ -180,6 +267,47 @@ class AstAttributeMechanism : public AttributeMechanism<std::string,AstAttribute
        // DQ (7/27/2008): Because we add an explicit copy constructor we
        // now need an explicit default constructor.
           AstAttributeMechanism ();
+
+       //! test if attribute "key" exists
+          bool exists(const AttributeKey & key) const;
+       //! returns the attribute "key", or NULL if it does not exist
+          AstAttribute* get(const AttributeKey & key) const;
+       //! add a new attribute. If attribute already exists, fail.
+          void add(const AttributeKey & key, AstAttribute* value);
+       //! replace an existing attribute "key", fail if the attribute does not exist
+          void replace(const AttributeKey & key, AstAttribute* value);
+       //! remove an existing attribute "key", fail if the attribute does not exist
+          void remove(const AttributeKey & key);
+       //! add the attribute "key" or replace it if it exists
+          void set(const AttributeKey & key, AstAttribute* value);
+       //! access the value of attribute "key". Fails if the attribute does not exist.
+          AstAttribute* operator[](const AttributeKey & key) const;
+
+       // The interface by name
+          bool exists(const std::string & name) const;
+          AstAttribute* get(const std::string & name) const;
+          void add(const std::string & name, AstAttribute* value);
+          void replace(const std::string & name, AstAttribute* value);
+          void remove(const std::string & name);
+          void set(const std::string & name, AstAttribute* value);
+          AstAttribute* operator[](const std::string & name) const;
+
+       //! get the set of all attribute names
+          AttributeIdentifiers getAttributeIdentifiers() const;
+
+       //! number of attributes in the container
+          int size() const { return entries.size(); }
+
+          iterator begin() { return iterator(entries.begin()); }
+          iterator end()   { return iterator(entries.end()); }
+
+     private:
+          EntryList entries;
+
+          EntryList::const_iterator find(const AttributeKey & key) const;
+          EntryList::iterator find(const AttributeKey & key);
+          EntryList::const_iterator find(const std::string & name) const;
+          EntryList::iterator find(const std::string & name);
    };
 
 
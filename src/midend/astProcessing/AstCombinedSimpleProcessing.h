@@ -43,6 +43,82 @@ private:
     TraversalPtrList::size_type numberOfTraversals;
 };
 
+// Combined simple traversal for large numbers of traversals that are each
+// only interested in a few kinds of nodes (checker suites and the like).
+// Every traversal is registered together with the variants it wants to
+// visit; at the start of the traversal a table from VariantT to the list of
+// interested traversals is built, and each node is only passed to the
+// traversals in its entry, in the order in which they were added.
+// Optionally, traversals may also declare variants below which nothing
+// they are interested in can occur; if subtree pruning is enabled and every
+// registered traversal declares a variant like this, the successors of
+// nodes of that variant are not traversed at all (the node itself is still
+// visited). A traversal added without a list of variants is interested in
+// every node and never allows pruning.
+class ROSE_DLL_API AstCombinedDispatchSimpleProcessing
+    : public AstSimpleProcessing
+{
+public:
+    typedef AstSimpleProcessing TraversalType;
+    typedef TraversalType *TraversalPtr;
+    typedef std::vector<TraversalPtr> TraversalPtrList;
+    typedef std::vector<VariantT> VariantList;
+
+    //! default constructor
+    AstCombinedDispatchSimpleProcessing();
+
+    //! add a traversal that visits every node
+    void addTraversal(TraversalPtr);
+    //! add a traversal that only visits nodes of the given variants; if
+    //! includeSubclasses is set, nodes of all variants derived from them are
+    //! visited as well. The traversal declares that nothing it visits occurs
+    //! below nodes of the variants in skippableSubtrees (subclasses are
+    //! included in the same way).
+    void addTraversal(TraversalPtr, const VariantList &variantsOfInterest,
+            bool includeSubclasses = true,
+            const VariantList &skippableSubtrees = VariantList());
+
+    //! enable or disable pruning of subtrees that no traversal needs; off by
+    //! default. A traversal that prunes anything reads the successors through
+    //! setNodeSuccessors() regardless of set_useDefaultIndexBasedTraversal();
+    //! the traversal engine and the flags set by the user are left unchanged.
+    void set_pruneUninterestingSubtrees(bool);
+
+    //! the traversals that visit nodes of the given variant, valid during
+    //! and after a traversal
+    const TraversalPtrList &get_dispatchList(VariantT variant) const;
+
+protected:
+    //! this method is called at every traversed node.
+    virtual void visit(SgNode* astNode);
+
+    //! used instead of index-based successor access if pruning is enabled
+    virtual void setNodeSuccessors(SgNode* node, SuccessorsContainer& succContainer);
+
+    virtual void atTraversalStart();
+    virtual void atTraversalEnd();
+
+private:
+    struct Registration
+    {
+        TraversalPtr traversal;
+        bool allVariants;
+        VariantList variantsOfInterest;
+        VariantList skippableSubtrees;
+    };
+    std::vector<Registration> registrations;
+
+    // indexed by VariantT, rebuilt at the start of each traversal
+    std::vector<TraversalPtrList> dispatchTable;
+    std::vector<bool> prunedVariants;
+    bool pruneUninterestingSubtrees;
+
+    // set while a pruning traversal overrides the index-based mode
+    bool switchedToSuccessorContainers;
+    bool savedUseDefaultIndexBasedTraversal;
+    void restoreTraversalMode();
+};
+
 class AstCombinedPrePostProcessing
     : public AstPrePostProcessing
 {
@@ -119,6 +119,9 @@ public:
     SgTreeTraversal(const SgTreeTraversal &);
     const SgTreeTraversal &operator=(const SgTreeTraversal &);
 
+    // Whether the index-based traversal mechanism is used (see set_useDefaultIndexBasedTraversal() below).
+    bool get_useDefaultIndexBasedTraversal() const;
+
     friend class SgCombinedTreeTraversal<InheritedAttributeType, SynthesizedAttributeType>;
    
 
@@ -159,13 +162,27 @@ protected:
     // who overrides setNodeSuccessors() *must* change this to false to force the traversal to use their custom
     // successor container.
     void set_useDefaultIndexBasedTraversal(bool);
+
+    // This flag selects the traversal engine. By default, performTraversal() recurses once per node. If the flag is
+    // set, performTraversalWithExplicitStack() is used instead: it keeps one frame per open node on a stack owned by
+    // the traversal object and reused by every subsequent traversal, so the native call stack no longer grows with
+    // the depth of the AST and no per-node containers are built in index-based mode. Visit order, the values passed
+    // to the evaluate*() functions and the synthesized attribute stack frames are identical for both engines.
+    void set_useExplicitStackTraversal(bool);
 private:
     void performTraversal(SgNode *basenode,
             InheritedAttributeType inheritedValue,
             t_traverseOrder travOrder);
+    void performTraversalWithExplicitStack(SgNode *basenode,
+            InheritedAttributeType inheritedValue,
+            t_traverseOrder travOrder);
+    void pushTraversalFrame(SgNode *node,
+            InheritedAttributeType inheritedValue,
+            t_traverseOrder travOrder);
     SynthesizedAttributeType traversalResult();
 
     bool useDefaultIndexBasedTraversal;
+    bool useExplicitStackTraversal;
     bool traversalConstraint;
     SgFile *fileToVisit;
 
@@ -173,6 +190,21 @@ private:
     // automagically called with the appropriate stack frame, which
     // behaves like a non-resizable std::vector
     SynthesizedAttributesList *synthesizedAttributes;
+
+    // explicit stack used by performTraversalWithExplicitStack(): one frame per node whose successors are
+    // still being visited. In successor container mode, successorContainers[i] holds the successors of the node in
+    // frame i; the containers are kept between traversals so that their storage is reused.
+    struct TraversalFrame
+    {
+        SgNode *node;
+        InheritedAttributeType inheritedValue;
+        size_t numberOfSuccessors;
+        size_t nextSuccessor;
+        // traversal successor fields of the node's type for the index-based traversal
+        const SgTraversalSuccessorField *successorFields;
+    };
+    std::vector<TraversalFrame> *traversalFrames;
+    std::vector<SuccessorsContainer> *successorContainers;
 };
 
 
@@ -180,6 +212,9 @@ private:
 template <class InheritedAttributeType, class SynthesizedAttributeType>
 class AstCombinedTopDownBottomUpProcessing;
 
+template <class InheritedAttributeType, class SynthesizedAttributeType>
+class AstTaskParallelTopDownBottomUpProcessing;
+
 template <class InheritedAttributeType, class SynthesizedAttributeType>
 class AstTopDownBottomUpProcessing
     : public SgTreeTraversal<InheritedAttributeType, SynthesizedAttributeType>
@@ -204,6 +239,7 @@ public:
     
 
     friend class AstCombinedTopDownBottomUpProcessing<InheritedAttributeType, SynthesizedAttributeType>;
+    friend class AstTaskParallelTopDownBottomUpProcessing<InheritedAttributeType, SynthesizedAttributeType>;
 
 protected:
     //! pure virtual function which must be implemented to compute the inherited attribute at a node
@@ -388,9 +424,12 @@ template<class InheritedAttributeType, class SynthesizedAttributeType>
 SgTreeTraversal<InheritedAttributeType, SynthesizedAttributeType>::
 SgTreeTraversal() 
   : useDefaultIndexBasedTraversal(true),
+    useExplicitStackTraversal(false),
     traversalConstraint(false),
     fileToVisit(NULL),
-    synthesizedAttributes(new SynthesizedAttributesList())
+    synthesizedAttributes(new SynthesizedAttributesList()),
+    traversalFrames(new std::vector<TraversalFrame>()),
+    successorContainers(new std::vector<SuccessorsContainer>())
 {
 }
 
@@ -403,6 +442,12 @@ SgTreeTraversal<InheritedAttributeType, SynthesizedAttributeType>::
     ROSE_ASSERT(synthesizedAttributes != NULL);
     delete synthesizedAttributes;
     synthesizedAttributes = NULL;
+
+    ROSE_ASSERT(traversalFrames != NULL && successorContainers != NULL);
+    delete traversalFrames;
+    traversalFrames = NULL;
+    delete successorContainers;
+    successorContainers = NULL;
 }
 
 
@@ -412,9 +457,14 @@ template<class InheritedAttributeType, class SynthesizedAttributeType>
 SgTreeTraversal<InheritedAttributeType, SynthesizedAttributeType>::
 SgTreeTraversal(const SgTreeTraversal &other)
   : useDefaultIndexBasedTraversal(other.useDefaultIndexBasedTraversal),
+    useExplicitStackTraversal(other.useExplicitStackTraversal),
     traversalConstraint(other.traversalConstraint),
     fileToVisit(other.fileToVisit),
-    synthesizedAttributes(other.synthesizedAttributes->deepCopy())
+    synthesizedAttributes(other.synthesizedAttributes->deepCopy()),
+    // the explicit stack only holds state while a traversal is running, so
+    // the copy starts out with a fresh one
+    traversalFrames(new std::vector<TraversalFrame>()),
+    successorContainers(new std::vector<SuccessorsContainer>())
 {
 }
 
@@ -424,6 +474,7 @@ SgTreeTraversal<InheritedAttributeType, SynthesizedAttributeType>::
 operator=(const SgTreeTraversal &other)
 {
     useDefaultIndexBasedTraversal = other.useDefaultIndexBasedTraversal;
+    useExplicitStackTraversal = other.useExplicitStackTraversal;
     traversalConstraint = other.traversalConstraint;
     fileToVisit = other.fileToVisit;
 
@@ -442,6 +493,22 @@ set_useDefaultIndexBasedTraversal(bool val)
     useDefaultIndexBasedTraversal = val;
 }
 
+template<class InheritedAttributeType, class SynthesizedAttributeType>
+bool
+SgTreeTraversal<InheritedAttributeType, SynthesizedAttributeType>::
+get_useDefaultIndexBasedTraversal() const
+{
+    return useDefaultIndexBasedTraversal;
+}
+
+template<class InheritedAttributeType, class SynthesizedAttributeType>
+void
+SgTreeTraversal<InheritedAttributeType, SynthesizedAttributeType>::
+set_useExplicitStackTraversal(bool val)
+{
+    useExplicitStackTraversal = val;
+}
+
 // MS: 03/22/02ROSE/tests/roseTests/astProcessingTests/
 // function to traverse all ASTs representing inputfiles (excluding include files), 
 template<class InheritedAttributeType, class SynthesizedAttributeType>
@@ -715,7 +782,10 @@ traverse(SgNode *node, InheritedAttributeType inheritedValue,
     atTraversalStart();
 
     // perform the actual traversal
-    performTraversal(node, inheritedValue, treeTraversalOrder);
+    if (useExplicitStackTraversal)
+        performTraversalWithExplicitStack(node, inheritedValue, treeTraversalOrder);
+    else
+        performTraversal(node, inheritedValue, treeTraversalOrder);
 
     // notify the traversal that we are done
     atTraversalEnd();
@@ -753,6 +823,7 @@ performTraversal(SgNode* node,
        // GB (09/25/2007): Added support for index-based traversals. The useDefaultIndexBasedTraversal flag tells us
        // whether to use successor containers or direct index-based access to the node's successors.
           AstSuccessorsSelectors::SuccessorsContainer succContainer;
+          const SgTraversalSuccessorField *successorFields = NULL;
           size_t numberOfSuccessors;
           if (!useDefaultIndexBasedTraversal)
              {
@@ -761,7 +832,10 @@ performTraversal(SgNode* node,
              }
             else
              {
-               numberOfSuccessors = node->get_numberOfTraversalSuccessors();
+            // The index-based access reads the successors through the generated table of the node's type rather than
+            // through a virtual call per successor.
+               successorFields = traversalSuccessorFields(node);
+               numberOfSuccessors = numberOfTraversalSuccessors(node, successorFields);
              }
 
           for (size_t idx = 0; idx < numberOfSuccessors; idx++)
@@ -771,7 +845,7 @@ performTraversal(SgNode* node,
                if (useDefaultIndexBasedTraversal)
                   {
                  // ROSE_ASSERT(node->get_traversalSuccessorByIndex(idx) != NULL || node->get_traversalSuccessorByIndex(idx) == NULL);
-                    child = node->get_traversalSuccessorByIndex(idx);
+                    child = traversalSuccessorByIndex(node, successorFields, idx);
                   }
                  else
                   {
@@ -826,6 +900,123 @@ performTraversal(SgNode* node,
        } // function body
 
 
+// Non-recursive equivalent of performTraversal(). Entering a node (evaluating
+// its inherited attribute and counting its successors) is done by
+// pushTraversalFrame(); the loop below then visits the successors of the
+// topmost frame one at a time and, once they are exhausted, evaluates the
+// synthesized attribute and pops the frame. The frames are indexed rather
+// than referenced across calls to user code because a user function may
+// start a nested traversal on this object, which grows the frame vector
+// (above our base) and may reallocate it.
+template<class InheritedAttributeType, class SynthesizedAttributeType>
+void
+SgTreeTraversal<InheritedAttributeType, SynthesizedAttributeType>::
+performTraversalWithExplicitStack(SgNode* node,
+        InheritedAttributeType inheritedValue,
+        t_traverseOrder treeTraversalOrder)
+   {
+     ROSE_ASSERT(traversalFrames != NULL && successorContainers != NULL);
+     const size_t base = traversalFrames->size();
+
+     try
+        {
+          pushTraversalFrame(node, inheritedValue, treeTraversalOrder);
+
+          while (traversalFrames->size() > base)
+             {
+               const size_t top = traversalFrames->size() - 1;
+               TraversalFrame &frame = (*traversalFrames)[top];
+
+               if (frame.nextSuccessor < frame.numberOfSuccessors)
+                  {
+                    const size_t idx = frame.nextSuccessor++;
+                    SgNode *child = useDefaultIndexBasedTraversal
+                                  ? traversalSuccessorByIndex(frame.node, frame.successorFields, idx)
+                                  : (*successorContainers)[top][idx];
+
+                    if (child != NULL)
+                       {
+                         pushTraversalFrame(child, frame.inheritedValue, treeTraversalOrder);
+                       }
+                      else
+                       {
+                      // null pointer (not traversed): we put the default value(s) of SynthesizedAttribute onto the stack
+                         if (treeTraversalOrder & postorder)
+                              synthesizedAttributes->push(defaultSynthesizedAttribute(frame.inheritedValue));
+                       }
+                  }
+                 else
+                  {
+                 // all successors are done; copy what we need out of the frame before calling user code
+                    SgNode *finishedNode = frame.node;
+                    InheritedAttributeType finishedValue = frame.inheritedValue;
+                    const size_t numberOfSuccessors = frame.numberOfSuccessors;
+                    traversalFrames->pop_back();
+
+                    if (treeTraversalOrder & postorder)
+                       {
+                         synthesizedAttributes->setFrameSize(numberOfSuccessors);
+                         ROSE_ASSERT(synthesizedAttributes->size() == numberOfSuccessors);
+                         synthesizedAttributes->push(evaluateSynthesizedAttribute(finishedNode, finishedValue, *synthesizedAttributes));
+                       }
+                  }
+             }
+        }
+     catch (...)
+        {
+       // leave the explicit stack as we found it; the synthesized attribute
+       // stack is reset by the next call to traverse()
+          traversalFrames->erase(traversalFrames->begin() + base, traversalFrames->end());
+          throw;
+        }
+   }
+
+// Enter a node on behalf of performTraversalWithExplicitStack(); this is the
+// part of performTraversal() that runs before the loop over the successors.
+template<class InheritedAttributeType, class SynthesizedAttributeType>
+void
+SgTreeTraversal<InheritedAttributeType, SynthesizedAttributeType>::
+pushTraversalFrame(SgNode* node,
+        InheritedAttributeType inheritedValue,
+        t_traverseOrder treeTraversalOrder)
+   {
+     if (node && SgTreeTraversal_inFileToTraverse(node, traversalConstraint, fileToVisit))
+        {
+          if (treeTraversalOrder & preorder)
+               inheritedValue = evaluateInheritedAttribute(node, inheritedValue);
+
+          TraversalFrame frame;
+          frame.node = node;
+          frame.inheritedValue = inheritedValue;
+          frame.nextSuccessor = 0;
+          frame.successorFields = NULL;
+
+          if (!useDefaultIndexBasedTraversal)
+             {
+               const size_t depth = traversalFrames->size();
+               if (successorContainers->size() <= depth)
+                    successorContainers->resize(depth + 1);
+               SuccessorsContainer &succContainer = (*successorContainers)[depth];
+               succContainer.clear();
+               setNodeSuccessors(node, succContainer);
+               frame.numberOfSuccessors = succContainer.size();
+             }
+            else
+             {
+               frame.successorFields = traversalSuccessorFields(node);
+               frame.numberOfSuccessors = numberOfTraversalSuccessors(node, frame.successorFields);
+             }
+
+          traversalFrames->push_back(frame);
+        }
+       else
+        {
+          if (treeTraversalOrder & postorder)
+               synthesizedAttributes->push(defaultSynthesizedAttribute(inheritedValue));
+        }
+   }
+
+
 // GB (05/30/2007)
 template <class InheritedAttributeType, class SynthesizedAttributeType>
 SynthesizedAttributeType SgTreeTraversal<InheritedAttributeType, SynthesizedAttributeType>::
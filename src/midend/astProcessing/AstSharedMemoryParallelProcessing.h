@@ -266,4 +266,6 @@ private:
 
 #include "AstSharedMemoryParallelSimpleProcessing.h"
 
+#include "AstTaskParallelProcessing.h"
+
 #endif
@@ -55,6 +55,7 @@ private:
 // AstPrePostProcessing, but that results in a (barely) measurable
 // performance hit.
 class AstCombinedSimpleProcessing;
+class AstCombinedDispatchSimpleProcessing;
 
 class ROSE_DLL_API AstSimpleProcessing
     : public SgTreeTraversal<DummyAttribute, DummyAttribute>
@@ -72,6 +73,7 @@ public:
     void traverseInputFiles(SgProject* projectNode, Order treeTraversalOrder);
 
     friend class AstCombinedSimpleProcessing;
+    friend class AstCombinedDispatchSimpleProcessing;
 
 protected:
     //! this method is called at every traversed node.
@@ -0,0 +1,138 @@
+// Class for task-parallel (multithreaded) evaluation of a single AST traversal.
+
+#ifndef ASTTASKPARALLELPROCESSING_H
+#define ASTTASKPARALLELPROCESSING_H
+
+#include "AstProcessing.h"
+#include "WorkerPool.h"
+
+#include <boost/exception_ptr.hpp>
+#include <deque>
+
+// The AstSharedMemoryParallel*Processing classes run a number of *different* traversals side by side in lockstep;
+// each of them still visits the whole AST sequentially. This class instead splits *one* AstTopDownBottomUpProcessing
+// over independent subtrees of the AST: whenever the traversal reaches a node for which isTaskRoot() returns true
+// (by default files, function definitions and class definitions), the subtree below it becomes a task that may be
+// executed by any worker thread. The inherited attribute computed at the parent is passed into the task, and the
+// synthesized attribute computed by the task is put into the parent's list of synthesized attributes at the position
+// of that child, so each evaluateSynthesizedAttribute() call sees exactly the same list it would see in a sequential
+// traversal. Tasks are kept in one deque per worker; a worker takes its own most recently spawned task first, and
+// idle workers steal the oldest (and therefore usually largest) task from another worker. A worker that must wait
+// for a child task to finish executes other tasks in the meantime, and workers with nothing to do sleep until a task
+// is spawned or completed.
+//
+// The relative order in which nodes in *different* tasks are visited is not defined, and the evaluate*() functions
+// of the traversal are called concurrently from several threads. They must therefore not modify state shared between
+// nodes without synchronization, and the user must say so explicitly by calling
+// set_evaluateFunctionsAreThreadSafe(true). Otherwise traverseInParallel() falls back to the traversal's ordinary
+// sequential traverse(). It does the same for traversals that select their successors with setNodeSuccessors()
+// instead of the default index-based successor access. atTraversalStart() and atTraversalEnd() are called once, from
+// the calling thread.
+//
+// If an evaluate*() function throws, no further tasks are started, and traverseInParallel() rethrows the first
+// exception once the tasks that are already running have completed; atTraversalEnd() is not called in that case. As
+// with WorkerPool::run(), exceptions not thrown with boost::enable_current_exception() are rethrown as
+// boost::unknown_exception.
+template <class InheritedAttributeType, class SynthesizedAttributeType>
+class AstTaskParallelTopDownBottomUpProcessing
+{
+public:
+    typedef AstTopDownBottomUpProcessing<InheritedAttributeType, SynthesizedAttributeType> TraversalType;
+    typedef TraversalType *TraversalPtr;
+    typedef typename TraversalType::SynthesizedAttributesList SynthesizedAttributesList;
+
+    AstTaskParallelTopDownBottomUpProcessing(TraversalPtr traversal);
+    virtual ~AstTaskParallelTopDownBottomUpProcessing();
+
+    //! evaluates attributes on the entire AST, using the configured number of threads (the calling thread included)
+    SynthesizedAttributeType traverseInParallel(SgNode *basenode, InheritedAttributeType inheritedValue);
+
+    void set_numberOfThreads(size_t threads);
+    //! declare that the evaluate*() functions of the traversal may be called concurrently; false by default
+    void set_evaluateFunctionsAreThreadSafe(bool val);
+
+protected:
+    //! decides whether the subtree below node is evaluated as a separate task; called concurrently from all workers
+    virtual bool isTaskRoot(SgNode *node);
+
+private:
+    struct Task
+    {
+        SgNode *node;
+        InheritedAttributeType inheritedValue;
+        SynthesizedAttributeType result;
+        bool done;
+
+        Task(SgNode *node, InheritedAttributeType inheritedValue)
+          : node(node), inheritedValue(inheritedValue), result(), done(false)
+        {
+        }
+    };
+
+    struct Worker
+    {
+#ifndef _MSC_VER
+        pthread_mutex_t mutex;
+#endif
+        std::deque<Task *> tasks;
+        // synthesized attributes of the nodes this worker is currently
+        // visiting, used exactly like the stack in SgTreeTraversal
+        SynthesizedAttributesList *synthesizedAttributes;
+    };
+
+    // the workers of a running traverseInParallel(): worker 0 is the calling
+    // thread and executes the root task, the others steal tasks
+    class WorkerJob : public WorkerPool::Job
+    {
+    public:
+        WorkerJob(AstTaskParallelTopDownBottomUpProcessing *processing, Task *root)
+          : processing(processing), root(root)
+        {
+        }
+        virtual void work(size_t worker);
+
+    private:
+        AstTaskParallelTopDownBottomUpProcessing *processing;
+        Task *root;
+    };
+    friend class WorkerJob;
+
+    // thrown out of a task that was abandoned because another task failed
+    struct Aborted
+    {
+    };
+
+    void executeStolenTasks(size_t worker);
+
+    void evaluateNode(size_t worker, SgNode *node, InheritedAttributeType inheritedValue);
+    void executeTask(size_t worker, Task *task);
+    void spawnTask(size_t worker, Task *task);
+    Task *takeOwnTask(size_t worker);
+    Task *stealTask(size_t worker);
+    void waitForTask(size_t worker, Task *task);
+    void abort();
+    bool isAborted();
+
+    TraversalPtr traversal;
+    size_t numberOfThreads;
+    bool evaluateFunctionsAreThreadSafe;
+
+    // state of a running traverseInParallel()
+    std::vector<Worker> workers;
+#ifndef _MSC_VER
+    pthread_mutex_t doneMutex;          // protects the following members and Task::done
+    pthread_cond_t stateChanged;        // signalled whenever one of them changes
+#endif
+    bool finished;
+    size_t numberOfSpawnedTasks;
+    bool aborted;
+    boost::exception_ptr error;         // the first exception thrown by an evaluate*() function
+
+    // not copyable: workers hold mutexes
+    AstTaskParallelTopDownBottomUpProcessing(const AstTaskParallelTopDownBottomUpProcessing &);
+    const AstTaskParallelTopDownBottomUpProcessing &operator=(const AstTaskParallelTopDownBottomUpProcessing &);
+};
+
+#include "AstTaskParallelProcessingImpl.h"
+
+#endif
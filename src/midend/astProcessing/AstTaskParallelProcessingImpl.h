@@ -0,0 +1,383 @@
+// Implementation of the task-parallel traversal; see the comment in
+// AstTaskParallelProcessing.h.
+
+#ifndef ASTTASKPARALLELPROCESSING_C
+#define ASTTASKPARALLELPROCESSING_C
+
+#ifdef _MSC_VER
+#pragma message ("Warning: pthread.h is unavailable on MSVC, AstTaskParallelTopDownBottomUpProcessing runs sequentially.")
+#else
+#include <pthread.h>
+#endif
+
+#include "AstTaskParallelProcessing.h"
+
+// Throughout this file, I is the InheritedAttributeType, S is the
+// SynthesizedAttributeType, as in AstSharedMemoryParallelProcessingImpl.h
+
+template <class I, class S>
+AstTaskParallelTopDownBottomUpProcessing<I, S>::
+AstTaskParallelTopDownBottomUpProcessing(typename AstTaskParallelTopDownBottomUpProcessing<I, S>::TraversalPtr traversal)
+  : traversal(traversal), numberOfThreads(2), evaluateFunctionsAreThreadSafe(false),
+    finished(false), numberOfSpawnedTasks(0), aborted(false)
+{
+    ROSE_ASSERT(traversal != NULL);
+}
+
+template <class I, class S>
+AstTaskParallelTopDownBottomUpProcessing<I, S>::
+~AstTaskParallelTopDownBottomUpProcessing()
+{
+}
+
+template <class I, class S>
+void
+AstTaskParallelTopDownBottomUpProcessing<I, S>::set_numberOfThreads(size_t threads)
+{
+    ROSE_ASSERT(threads > 0);
+    numberOfThreads = threads;
+}
+
+template <class I, class S>
+void
+AstTaskParallelTopDownBottomUpProcessing<I, S>::set_evaluateFunctionsAreThreadSafe(bool val)
+{
+    evaluateFunctionsAreThreadSafe = val;
+}
+
+template <class I, class S>
+bool
+AstTaskParallelTopDownBottomUpProcessing<I, S>::isTaskRoot(SgNode *node)
+{
+    return isSgFile(node) != NULL || isSgFunctionDefinition(node) != NULL || isSgClassDefinition(node) != NULL;
+}
+
+template <class I, class S>
+S
+AstTaskParallelTopDownBottomUpProcessing<I, S>::traverseInParallel(SgNode *basenode, I inheritedValue)
+{
+#ifndef _MSC_VER
+    if (!evaluateFunctionsAreThreadSafe || numberOfThreads < 2 || basenode == NULL
+        || !traversal->get_useDefaultIndexBasedTraversal())
+#endif
+        return traversal->traverse(basenode, inheritedValue);
+
+#ifndef _MSC_VER
+    size_t i;
+    workers.resize(numberOfThreads);
+    for (i = 0; i < numberOfThreads; i++)
+    {
+        pthread_mutex_init(&workers[i].mutex, NULL);
+        workers[i].synthesizedAttributes = new SynthesizedAttributesList();
+    }
+    pthread_mutex_init(&doneMutex, NULL);
+    pthread_cond_init(&stateChanged, NULL);
+    finished = false;
+    numberOfSpawnedTasks = 0;
+    aborted = false;
+    error = boost::exception_ptr();
+
+    traversal->atTraversalStart();
+
+    // The calling thread is worker 0; the others run on the threads of the
+    // worker pool, start out idle and steal the tasks it spawns.
+    Task root(basenode, inheritedValue);
+    WorkerJob job(this, &root);
+    WorkerPool::run(job, numberOfThreads);
+
+    for (i = 0; i < numberOfThreads; i++)
+    {
+        ROSE_ASSERT(workers[i].tasks.empty());
+        pthread_mutex_destroy(&workers[i].mutex);
+        delete workers[i].synthesizedAttributes;
+    }
+    pthread_cond_destroy(&stateChanged);
+    pthread_mutex_destroy(&doneMutex);
+    workers.clear();
+
+    if (error)
+    {
+        boost::exception_ptr e = error;
+        error = boost::exception_ptr();
+        boost::rethrow_exception(e);
+    }
+
+    traversal->atTraversalEnd();
+
+    return root.result;
+#endif
+}
+
+#ifndef _MSC_VER
+template <class I, class S>
+void
+AstTaskParallelTopDownBottomUpProcessing<I, S>::WorkerJob::work(size_t worker)
+{
+    if (worker == 0)
+    {
+        processing->executeTask(0, root);
+
+        pthread_mutex_lock(&processing->doneMutex);
+        processing->finished = true;
+        pthread_cond_broadcast(&processing->stateChanged);
+        pthread_mutex_unlock(&processing->doneMutex);
+    }
+    else
+    {
+        processing->executeStolenTasks(worker);
+    }
+}
+
+// This is what the workers other than the calling thread do: steal and
+// execute tasks until the root task has been completed, sleeping while
+// there is nothing to steal.
+template <class I, class S>
+void
+AstTaskParallelTopDownBottomUpProcessing<I, S>::executeStolenTasks(size_t worker)
+{
+    while (true)
+    {
+        // any task spawned after this point wakes us up below
+        pthread_mutex_lock(&doneMutex);
+        bool finished = this->finished;
+        size_t spawned = numberOfSpawnedTasks;
+        pthread_mutex_unlock(&doneMutex);
+        if (finished)
+            break;
+
+        Task *task = stealTask(worker);
+        if (task != NULL)
+        {
+            executeTask(worker, task);
+            continue;
+        }
+
+        pthread_mutex_lock(&doneMutex);
+        while (!this->finished && numberOfSpawnedTasks == spawned)
+            pthread_cond_wait(&stateChanged, &doneMutex);
+        pthread_mutex_unlock(&doneMutex);
+    }
+}
+
+// Evaluate a whole task on the given worker's attribute stack; the single
+// attribute this leaves on the stack is the task's result. Does not throw:
+// the first exception of an evaluate*() function is kept for
+// traverseInParallel() to rethrow, and once there was one, the remaining
+// tasks are completed without evaluating anything. The attribute stack of
+// the worker is left in disorder then, but all tasks that still use it are
+// abandoned as well.
+template <class I, class S>
+void
+AstTaskParallelTopDownBottomUpProcessing<I, S>::executeTask(size_t worker, Task *task)
+{
+    SynthesizedAttributesList *synthesizedAttributes = workers[worker].synthesizedAttributes;
+    S result = S();
+    if (!isAborted())
+    {
+        try
+        {
+            evaluateNode(worker, task->node, task->inheritedValue);
+            result = synthesizedAttributes->pop();
+        }
+        catch (const Aborted &)
+        {
+        }
+        catch (...)
+        {
+            pthread_mutex_lock(&doneMutex);
+            if (!error)
+                error = boost::current_exception();
+            pthread_mutex_unlock(&doneMutex);
+            abort();
+        }
+    }
+
+    pthread_mutex_lock(&doneMutex);
+    task->result = result;
+    task->done = true;
+    pthread_cond_broadcast(&stateChanged);
+    pthread_mutex_unlock(&doneMutex);
+}
+
+// The equivalent of SgTreeTraversal::performTraversal() for a node that is
+// known to be non-null, except that successors that are task roots are
+// spawned as tasks. A placeholder is pushed for each of them and replaced by
+// the task's result once all successors are done, so the stack frame passed
+// to evaluateSynthesizedAttribute() is the same as in a sequential traversal.
+template <class I, class S>
+void
+AstTaskParallelTopDownBottomUpProcessing<I, S>::evaluateNode(size_t worker, SgNode *node, I inheritedValue)
+{
+    SynthesizedAttributesList *synthesizedAttributes = workers[worker].synthesizedAttributes;
+
+    inheritedValue = traversal->evaluateInheritedAttribute(node, inheritedValue);
+
+    size_t numberOfSuccessors = node->get_numberOfTraversalSuccessors();
+    std::vector<std::pair<size_t, Task *> > spawned;
+    spawned.reserve(numberOfSuccessors);
+    typename std::vector<std::pair<size_t, Task *> >::iterator s;
+    try
+    {
+        for (size_t idx = 0; idx < numberOfSuccessors; idx++)
+        {
+            SgNode *child = node->get_traversalSuccessorByIndex(idx);
+
+            if (child == NULL)
+            {
+                synthesizedAttributes->push(traversal->defaultSynthesizedAttribute(inheritedValue));
+            }
+            else if (isTaskRoot(child))
+            {
+                Task *task = new Task(child, inheritedValue);
+                spawnTask(worker, task);
+                spawned.push_back(std::make_pair(idx, task));
+                synthesizedAttributes->push(S());
+            }
+            else
+            {
+                evaluateNode(worker, child, inheritedValue);
+            }
+        }
+    }
+    catch (...)
+    {
+        // another worker may be executing one of our tasks; they must be
+        // complete before they can be deleted
+        abort();
+        for (s = spawned.begin(); s != spawned.end(); ++s)
+        {
+            waitForTask(worker, s->second);
+            delete s->second;
+        }
+        throw;
+    }
+
+    // Any task executed while waiting leaves the stack as it found it, so
+    // our successors' attributes are still on top afterwards.
+    for (s = spawned.begin(); s != spawned.end(); ++s)
+        waitForTask(worker, s->second);
+
+    if (isAborted())
+    {
+        for (s = spawned.begin(); s != spawned.end(); ++s)
+            delete s->second;
+        throw Aborted();
+    }
+
+    synthesizedAttributes->setFrameSize(numberOfSuccessors);
+    ROSE_ASSERT(synthesizedAttributes->size() == numberOfSuccessors);
+    for (s = spawned.begin(); s != spawned.end(); ++s)
+    {
+        (*synthesizedAttributes)[s->first] = s->second->result;
+        delete s->second;
+    }
+    synthesizedAttributes->push(traversal->evaluateSynthesizedAttribute(node, inheritedValue, *synthesizedAttributes));
+}
+
+template <class I, class S>
+void
+AstTaskParallelTopDownBottomUpProcessing<I, S>::spawnTask(size_t worker, Task *task)
+{
+    pthread_mutex_lock(&workers[worker].mutex);
+    workers[worker].tasks.push_back(task);
+    pthread_mutex_unlock(&workers[worker].mutex);
+
+    pthread_mutex_lock(&doneMutex);
+    numberOfSpawnedTasks++;
+    pthread_cond_broadcast(&stateChanged);
+    pthread_mutex_unlock(&doneMutex);
+}
+
+// The owner works on the newest end of its deque...
+template <class I, class S>
+typename AstTaskParallelTopDownBottomUpProcessing<I, S>::Task *
+AstTaskParallelTopDownBottomUpProcessing<I, S>::takeOwnTask(size_t worker)
+{
+    Task *task = NULL;
+    pthread_mutex_lock(&workers[worker].mutex);
+    if (!workers[worker].tasks.empty())
+    {
+        task = workers[worker].tasks.back();
+        workers[worker].tasks.pop_back();
+    }
+    pthread_mutex_unlock(&workers[worker].mutex);
+    return task;
+}
+
+// ... while thieves take the oldest task of the first other worker that has one.
+template <class I, class S>
+typename AstTaskParallelTopDownBottomUpProcessing<I, S>::Task *
+AstTaskParallelTopDownBottomUpProcessing<I, S>::stealTask(size_t worker)
+{
+    for (size_t i = 1; i < numberOfThreads; i++)
+    {
+        size_t victim = (worker + i) % numberOfThreads;
+        Task *task = NULL;
+        pthread_mutex_lock(&workers[victim].mutex);
+        if (!workers[victim].tasks.empty())
+        {
+            task = workers[victim].tasks.front();
+            workers[victim].tasks.pop_front();
+        }
+        pthread_mutex_unlock(&workers[victim].mutex);
+        if (task != NULL)
+            return task;
+    }
+    return NULL;
+}
+
+// Wait for a spawned task to complete, executing other tasks meanwhile: our
+// own newest task first (usually the one we are waiting for, if it was not
+// stolen), otherwise one stolen from another worker. If there is none, sleep
+// until a task is spawned or completed.
+template <class I, class S>
+void
+AstTaskParallelTopDownBottomUpProcessing<I, S>::waitForTask(size_t worker, Task *task)
+{
+    while (true)
+    {
+        pthread_mutex_lock(&doneMutex);
+        bool done = task->done;
+        size_t spawned = numberOfSpawnedTasks;
+        pthread_mutex_unlock(&doneMutex);
+        if (done)
+            break;
+
+        Task *other = takeOwnTask(worker);
+        if (other == NULL)
+            other = stealTask(worker);
+        if (other != NULL)
+        {
+            executeTask(worker, other);
+            continue;
+        }
+
+        pthread_mutex_lock(&doneMutex);
+        while (!task->done && numberOfSpawnedTasks == spawned)
+            pthread_cond_wait(&stateChanged, &doneMutex);
+        pthread_mutex_unlock(&doneMutex);
+    }
+}
+
+// Abandon the tasks that have not been started yet.
+template <class I, class S>
+void
+AstTaskParallelTopDownBottomUpProcessing<I, S>::abort()
+{
+    pthread_mutex_lock(&doneMutex);
+    aborted = true;
+    pthread_mutex_unlock(&doneMutex);
+}
+
+template <class I, class S>
+bool
+AstTaskParallelTopDownBottomUpProcessing<I, S>::isAborted()
+{
+    pthread_mutex_lock(&doneMutex);
+    bool aborted = this->aborted;
+    pthread_mutex_unlock(&doneMutex);
+    return aborted;
+}
+#endif
+
+#endif
@@ -6,6 +6,7 @@
 //#include "sage3.h"
 #include "AstProcessing.h"
 #include "rosedll.h"
+#include "WorkerPool.h"
 
 #include <functional>
 // Support for operations like (SgTypeInt | SgTypeFloat)
@@ -40,6 +41,28 @@ ROSE_DLL_API VariantVector operator+ (VariantT lhs, const VariantVector & rhs);
 ROSE_DLL_API VariantVector operator+ (const VariantVector & lhs, VariantT rhs);
 ROSE_DLL_API VariantVector operator+ (const VariantVector & lhs, const VariantVector & rhs);
 
+// The variants of a VariantVector as one bit per variant, so that the queries based on a
+// VariantVector test each node with a single bit test instead of a scan over the vector.
+// The variants are taken as they are in the vector (the VariantVector(VariantT) constructor
+// already adds the variants of all subclasses).
+class ROSE_DLL_API VariantBitSet
+{
+  public:
+    VariantBitSet ();
+    VariantBitSet (const VariantVector & X);
+
+    bool contains (VariantT v) const { return bits[v]; }
+    bool contains (SgNode* node) const { return bits[node->variantT()]; }
+
+    // true if any of the variants is an SgType (types have to be extracted from the
+    // data members of the traversed nodes since they are not traversed)
+    bool containsTypes () const { return anyType; }
+
+  private:
+    std::vector<bool> bits;
+    bool anyType;
+};
+
 
 
 
@@ -471,8 +494,56 @@ _Result queryMemoryPool (
   return queryMemoryPool(std::ptr_fun(__x),targetVariantVector);
 }
 
+  /********************************************************************************
+   * The function
+   *      void traverseMemoryPoolInParallel(const std::vector<ROSE_VisitTraversal*>& visitors,
+   *                   VariantVector* targetVariantVector = NULL)
+   * visits every allocated IR node in the memory pools of the variants in the
+   * VariantVector (all memory pools if it is NULL) using one thread of the WorkerPool
+   * per visitor (the calling thread included). The work is split into chunks of one block of one memory
+   * pool each; the threads take the next chunk until none is left, and visitors[i] is
+   * only ever called from thread i, so the visitors can accumulate their results without
+   * synchronization. The order in which the nodes are visited is not defined. No IR
+   * node may be allocated or deleted while the traversal runs.
+   ********************************************************************************/
+  ROSE_DLL_API void traverseMemoryPoolInParallel(const std::vector<ROSE_VisitTraversal*>& visitors, VariantVector* targetVariantVector = NULL);
+
+  /********************************************************************************
+   * The function
+   *      NodeFunctional::result_type queryMemoryPoolInParallel(NodeFunctional nodeFunc,
+   *                   size_t numberOfThreads, VariantVector* targetVariantVector = NULL)
+   * is queryMemoryPool() using traverseMemoryPoolInParallel(). Every thread applies its
+   * own copy of the functional (which therefore must not modify shared state) and
+   * collects its own result; the results are merged in the order of the threads, so the
+   * order of the returned list is not defined either.
+   ********************************************************************************/
+  template<typename NodeFunctional>
+    typename NodeFunctional::result_type 
+    queryMemoryPoolInParallel(NodeFunctional nodeFunc, size_t numberOfThreads, VariantVector* targetVariantVector = NULL)
+    {
+      ROSE_ASSERT(numberOfThreads > 0);
+      typedef AstQuery<ROSE_VisitTraversal,NodeFunctional> QueryType;
+
+      // the threads collect into queries on cache lines of their own
+      std::vector<WorkerPool::CacheLinePadded<NodeFunctional> > nodeFuncs(numberOfThreads, WorkerPool::CacheLinePadded<NodeFunctional>(nodeFunc));
+      std::vector<WorkerPool::CacheLinePadded<QueryType> > queries(numberOfThreads, WorkerPool::CacheLinePadded<QueryType>(QueryType(&nodeFuncs[0].value)));
+      std::vector<ROSE_VisitTraversal*> visitors(numberOfThreads);
+      for (size_t i = 0; i < numberOfThreads; i++)
+      {
+        queries[i].value.setPredicate(&nodeFuncs[i].value);
+        visitors[i] = &queries[i].value;
+      }
 
+      traverseMemoryPoolInParallel(visitors, targetVariantVector);
 
+      typename NodeFunctional::result_type returnList = queries[0].value.get_listOfNodes();
+      for (size_t i = 1; i < numberOfThreads; i++)
+      {
+        typename NodeFunctional::result_type threadList = queries[i].value.get_listOfNodes();
+        Merge(returnList, threadList);
+      }
+      return returnList;
+    }
 
 };// END NAMESPACE ASTQUERY
 
@@ -185,8 +185,13 @@ namespace NodeQuery
 
   // Functions supporting the query of variants
   void pushNewNode ( NodeQuerySynthesizedAttributeType* nodeList, const VariantVector & targetVariantVector, SgNode * astNode);
-  void* querySolverGrammarElementFromVariantVector ( SgNode * astNode, VariantVector targetVariantVector,  NodeQuerySynthesizedAttributeType* returnNodeList );
-  NodeQuerySynthesizedAttributeType querySolverGrammarElementFromVariantVector ( SgNode * astNode, VariantVector targetVariantVector );
+  void* querySolverGrammarElementFromVariantVector ( SgNode * astNode, const VariantVector & targetVariantVector,  NodeQuerySynthesizedAttributeType* returnNodeList );
+  NodeQuerySynthesizedAttributeType querySolverGrammarElementFromVariantVector ( SgNode * astNode, const VariantVector & targetVariantVector );
+
+  // The same with the target variants compiled into a VariantBitSet once per query (used by querySubTree
+  // and queryNodeList); a node is added at most once.
+  void pushNewNode ( NodeQuerySynthesizedAttributeType* nodeList, const VariantBitSet & targetVariants, SgNode * astNode);
+  void* querySolverGrammarElementFromVariantVector ( SgNode * astNode, const VariantBitSet & targetVariants,  NodeQuerySynthesizedAttributeType* returnNodeList );
 
 
    /********************************************************************************************
@@ -282,23 +287,19 @@ namespace NodeQuery
   // Liao, 8/27/2009, a more generic nodeList query, not just for nodes of type SgNode*
   template <typename T>
   Rose_STL_Container <T*>
-  queryNodeList ( Rose_STL_Container <T*> queryList, VariantVector targetVector)
+  queryNodeList ( const Rose_STL_Container <T*> & queryList, const VariantVector & targetVector)
      {
        Rose_STL_Container <T*> result;
+       result.reserve(queryList.size());
+       VariantBitSet targetVariants(targetVector);
     // Rose_STL_Container <T*>::iterator iter; // not recognized ??
        size_t i=0;
        for (i = 0; i < queryList.size(); i++)
           {
             SgNode* node = dynamic_cast<SgNode*> (queryList[i]);
             ROSE_ASSERT(node != NULL);
-            for (VariantVector::const_iterator iter = targetVector.begin(); iter != targetVector.end(); iter++)
-               {
-                 if (node->variantT() == *iter)
-                    {
-                      result.push_back(queryList[i]);
-                      break;
-                    }
-               }
+            if (targetVariants.contains(node))
+                 result.push_back(queryList[i]);
           }
 
        return result;
@@ -309,7 +310,7 @@ namespace NodeQuery
   ROSE_DLL_API
   inline
   Rose_STL_Container <T*>
-  queryNodeList ( Rose_STL_Container <T*> queryList, VariantT targetVariant)
+  queryNodeList ( const Rose_STL_Container <T*> & queryList, VariantT targetVariant)
      {
        return queryNodeList<T>( queryList, VariantVector(targetVariant));
 #if 0    
@@ -339,10 +340,10 @@ namespace NodeQuery
    * variants in VariantVector.
    *********************************************************************************************/
   ROSE_DLL_API NodeQuerySynthesizedAttributeType
-  querySubTree (SgNode * subTree, VariantVector targetVariantVector, AstQueryNamespace::QueryDepth defineQueryType = AstQueryNamespace::AllNodes);
+  querySubTree (SgNode * subTree, const VariantVector & targetVariantVector, AstQueryNamespace::QueryDepth defineQueryType = AstQueryNamespace::AllNodes);
 
   // DQ (3/25/2004): Added to support more general form of query based on variant value
-  ROSE_DLL_API NodeQuerySynthesizedAttributeType queryNodeList ( NodeQuerySynthesizedAttributeType, VariantVector);
+  ROSE_DLL_API NodeQuerySynthesizedAttributeType queryNodeList ( const NodeQuerySynthesizedAttributeType &, const VariantVector &);
 
   void
   mergeList (Rose_STL_Container<SgNode*> & nodeList, const Rose_STL_Container<SgNode*> & localList);
@@ -428,6 +429,16 @@ namespace NodeQuery
   ROSE_DLL_API DefaultNodeFunctional::result_type 
   queryMemoryPool(VariantVector& targetVariantVector);
 
+/********************************************************************************
+ * The function
+ *  DefaultNodeFunctional::result_type
+ *             queryMemoryPoolInParallel(VariantVector& targetVariantVector, size_t numberOfThreads);
+ * is queryMemoryPool(VariantVector&) with the blocks of the memory pools distributed over
+ * numberOfThreads threads. The order of the returned nodes is not defined.
+ ********************************************************************************/
+  ROSE_DLL_API DefaultNodeFunctional::result_type 
+  queryMemoryPoolInParallel(VariantVector& targetVariantVector, size_t numberOfThreads);
+
 
 // END NAMESPACE NodeQuery2
 }
@@ -0,0 +1,104 @@
+#ifndef ROSE_BlockCompression_H
+#define ROSE_BlockCompression_H
+
+#include "rosedll.h"
+
+#include <boost/thread.hpp>
+#include <deque>
+#include <ostream>
+#include <stdint.h>
+#include <streambuf>
+#include <utility>
+#include <vector>
+
+/** Fast block compression of large binary files.
+ *
+ *  The codec is a byte-oriented LZ77 variant in the style of LZ4: each sequence is a token byte holding the number of
+ *  literals and the length of a match, the literals, and a 16-bit offset back to the match. It compresses several hundred
+ *  megabytes per second and decompresses faster still, at the expense of a lower compression ratio than zlib, which suits
+ *  files like the AST File I/O's that are written and read as a whole.
+ *
+ *  Large files are split into chunks that are compressed independently, in parallel, and stored in a container that ends
+ *  with an index of the chunks, so they can also be decompressed in parallel:
+ *
+ * @code
+ *  "ROSE_CHUNKS_V001"                          16 bytes
+ *  chunk data                                  each chunk is stored compressed, or raw if compression does not help
+ *  index                                       per chunk: uint64_t uncompressed size, uint64_t stored size
+ *  uint64_t number of chunks
+ *  uint64_t total uncompressed size
+ *  "ROSE_CHUNKS_END!"                          16 bytes
+ * @endcode
+ *
+ *  Sizes are stored in the byte order of the host, as is everything else in the AST File I/O. */
+namespace BlockCompression {
+
+/** Compresses @p size bytes starting at @p input and appends the compressed block to @p output. */
+ROSE_DLL_API void compress(const uint8_t *input, size_t size, std::vector<uint8_t> &output/*in,out*/);
+
+/** Decompresses a block produced by compress() into exactly @p outputSize bytes at @p output. Returns false if the block
+ *  is corrupt or does not decompress to @p outputSize bytes. */
+ROSE_DLL_API bool decompress(const uint8_t *input, size_t size, uint8_t *output, size_t outputSize);
+
+/** True if the @p size bytes at @p data start like a container; used to tell containers from other files early. */
+ROSE_DLL_API bool isContainer(const uint8_t *data, size_t size);
+
+/** Returns the total uncompressed size of the chunks in a container that spans @p size bytes at @p data, or zero if the
+ *  data is not a complete container. */
+ROSE_DLL_API uint64_t containerSize(const uint8_t *data, size_t size);
+
+/** Decompresses all chunks of a container into @p output, which must have room for containerSize() bytes, using up to
+ *  @p nthreads threads (zero means one per processor). Returns false if any chunk is corrupt. */
+ROSE_DLL_API bool decompressContainer(const uint8_t *data, size_t size, uint8_t *output, size_t nthreads=0);
+
+/** Stream buffer that writes a container of compressed chunks.
+ *
+ *  Data written to the buffer is collected into chunks, which are compressed by worker threads while the writer produces
+ *  the next chunks, and written to the underlying stream in order. The container is complete only after finish() has been
+ *  called, which the destructor does if it wasn't called explicitly. */
+class ROSE_DLL_API CompressingStreamBuffer: public std::streambuf {
+public:
+    /** Writes the container to @p out using up to @p nthreads compressing threads (zero means one per processor). */
+    explicit CompressingStreamBuffer(std::ostream &out, size_t nthreads=0, size_t chunkSize=4*1024*1024);
+    ~CompressingStreamBuffer();
+
+    /** Writes the remaining chunks and the index. Returns false if writing to the underlying stream failed. */
+    bool finish();
+
+protected:
+    virtual int_type overflow(int_type c);
+
+private:
+    struct Chunk {
+        std::vector<uint8_t> input;
+        std::vector<uint8_t> output;
+        bool done;
+        Chunk(): done(false) {}
+    };
+
+    void submitChunk();
+    void writeChunk(Chunk *chunk);
+    void compressChunks();
+
+    std::ostream &out_;
+    size_t chunkSize_;
+    std::vector<char> buffer_;                                  // the chunk being filled, the put area
+    std::vector<std::pair<uint64_t, uint64_t> > index_;         // uncompressed and stored size of the chunks written
+    bool finished_;
+
+    boost::mutex mutex_;                                        // protects the following data members
+    boost::condition_variable chunkSubmitted_;
+    boost::condition_variable chunkCompressed_;
+    std::deque<Chunk*> pending_;                                // chunks not yet written, in order
+    std::deque<Chunk*> unclaimed_;                              // chunks that no worker has started to compress
+    bool stopping_;
+    std::vector<boost::thread*> workers_;
+
+    // not implemented
+    CompressingStreamBuffer(const CompressingStreamBuffer&);
+    CompressingStreamBuffer& operator=(const CompressingStreamBuffer&);
+};
+
+} // namespace
+
+#endif
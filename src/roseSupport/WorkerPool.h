@@ -0,0 +1,78 @@
+#ifndef ROSE_WorkerPool_H
+#define ROSE_WorkerPool_H
+
+#include "rosedll.h"
+
+#include <cstddef>
+
+/** Threads shared by the parallel traversals and queries of ROSE.
+ *
+ *  A job is divided among a number of workers, numbered from zero. The calling thread is always worker zero; the other
+ *  workers run on threads of a process-wide pool that are created when first needed and then kept for later jobs, so
+ *  running small jobs often does not create threads over and over again. The pool runs one job at a time: a job that is
+ *  started while another one is running (from another thread, or from within a worker of the running job) runs all of its
+ *  workers one after the other on the calling thread, as it also does for the workers that no thread could be created for.
+ *  A worker must therefore never wait for a worker with a higher number. Worker zero may be waited for, since it is
+ *  always the first one to run.
+ *
+ * @code
+ *  struct Sum: WorkerPool::IndexJob {
+ *      std::vector<WorkerPool::CacheLinePadded<long> > sums;     // one per worker
+ *      void work(size_t worker, size_t index) { sums[worker].value += f(index); }
+ *  };
+ *  Sum sum;
+ *  sum.sums.resize(nworkers);
+ *  WorkerPool::forEachIndex(sum, n, nworkers);
+ * @endcode */
+namespace WorkerPool {
+
+/** Size of a cache line, the unit in which memory is shared between processors. */
+static const size_t cacheLineSize = 64;
+
+/** A value that does not share a cache line with the values next to it in an array.
+ *
+ *  Values that are written by different workers, such as per-worker results, are kept apart this way so that the
+ *  processors do not have to pass the cache line back and forth on every write ("false sharing"). */
+template<class T>
+struct CacheLinePadded {
+    T value;
+    char padding[cacheLineSize];
+
+    CacheLinePadded(): value() {}
+    explicit CacheLinePadded(const T &value): value(value) {}
+};
+
+/** Work divided among a number of workers. */
+class ROSE_DLL_API Job {
+public:
+    virtual ~Job() {}
+
+    /** Does the share of the work of worker number @p worker. Called once for every worker, concurrently. */
+    virtual void work(size_t worker) = 0;
+};
+
+/** Work on every index of a range. */
+class ROSE_DLL_API IndexJob {
+public:
+    virtual ~IndexJob() {}
+
+    /** Does the work for @p index on worker number @p worker. Called once for every index, concurrently. */
+    virtual void work(size_t worker, size_t index) = 0;
+};
+
+/** Calls job.work(worker) for every worker in [0, @p nworkers) and returns once all of them have returned. If any of them
+ *  throws, the first exception is rethrown on the calling thread after all workers have returned; exceptions that were
+ *  not thrown with boost::enable_current_exception() are rethrown as boost::unknown_exception. */
+ROSE_DLL_API void run(Job &job, size_t nworkers);
+
+/** Calls job.work(worker, index) for every index in [0, @p n) using up to @p nworkers workers, which take the next index
+ *  from a shared counter until none is left. The indices are taken in increasing order. Once a call throws, no more
+ *  indices are taken and the exception is rethrown as by run(). */
+ROSE_DLL_API void forEachIndex(IndexJob &job, size_t n, size_t nworkers);
+
+/** The number of workers to use by default: one per processor. */
+ROSE_DLL_API size_t defaultNumberOfWorkers();
+
+} // namespace
+
+#endif
@@ -0,0 +1,61 @@
+#ifndef ROSE_MemoryPoolAllocator_H
+#define ROSE_MemoryPoolAllocator_H
+
+#include "rosedll.h"
+
+#include <stddef.h>
+#include <vector>
+
+/** Allocation of the memory blocks that form the memory pools of the IR node classes.
+ *
+ *  By default a block is obtained from calloc(). Whole-program ASTs span many gigabytes though, and traversing them
+ *  suffers from TLB misses and, on multi-socket machines, from remote memory accesses. The memory pools can therefore
+ *  be backed by anonymous memory mappings instead, which are advised to use transparent huge pages and/or placed on
+ *  particular NUMA nodes. Either must be configured before the IR nodes whose pools should be affected are allocated;
+ *  blocks that already exist are not moved.
+ *
+ *  Blocks smaller than a huge page share larger mappings, which are placed as a whole; the pages of such a block are given
+ *  back to the system when it is deallocated, and its address range is reused for the next block of the same size.
+ *
+ *  Huge pages only pay off for blocks of at least hugePageSize() bytes, so the block size of the heavily used IR node
+ *  classes should be raised accordingly with setMemoryPoolBlockSize() (declared in Cxx_Grammar.h). On systems other
+ *  than Linux the huge page and NUMA settings are accepted but have no effect. */
+class ROSE_DLL_API MemoryPoolAllocator {
+public:
+    /** Placement of the memory pools on NUMA nodes. */
+    enum NumaPolicy {
+        NUMA_DEFAULT,                                   /**< Whatever the process's memory policy says (usually first touch). */
+        NUMA_INTERLEAVE,                                /**< Pages are interleaved over the configured nodes. */
+        NUMA_BIND                                       /**< Pages are allocated on the configured nodes only. */
+    };
+
+    /** Whether memory blocks are advised to use transparent huge pages. False by default.
+     * @{ */
+    static void set_useHugePages(bool b);
+    static bool get_useHugePages();
+    /** @} */
+
+    /** NUMA policy for memory blocks. The @p nodes must not be empty unless the policy is NUMA_DEFAULT.
+     * @{ */
+    static void set_numaPolicy(NumaPolicy policy, const std::vector<int> &nodes = std::vector<int>());
+    static NumaPolicy get_numaPolicy();
+    static std::vector<int> get_numaNodes();
+    /** @} */
+
+    /** Size of a transparent huge page in bytes (2 MiB on x86-64). */
+    static size_t hugePageSize();
+
+    /** Returns a new zero-filled memory block of @p size bytes. Aborts if no memory is available. Thread safe. */
+    static void *allocateBlock(size_t size);
+
+    /** Releases a block returned by allocateBlock(); @p size must be the size it was allocated with. Thread safe. */
+    static void deallocateBlock(void *block, size_t size);
+
+    /** Calls @p release(@p cache) when the calling thread exits. The memory pools use this to give back the free objects
+     *  that a thread caches for itself (see DEFAULT_CLASS_ALLOCATION_MAGAZINE_SIZE). The functions registered by a thread
+     *  are called in the reverse order of registration; they are not called for the thread that runs main(), since its
+     *  caches last until the process exits anyway. Does nothing where POSIX threads are not available. */
+    static void atThreadExit(void (*release)(void*), void *cache);
+};
+
+#endif